@@ -0,0 +1,223 @@
+#include "bench.h"
+#include "tparallel.h"
+#include "tsimd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+// Подсчет выделений памяти: замена глобальных operator new/delete
+// (обычных и с выравниванием, которые использует TAlignedAllocator)
+static std::atomic<size_t> allocCount(0);
+static std::atomic<size_t> allocBytes(0);
+
+static void* BenchMalloc(size_t n, size_t align)
+{
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(n, std::memory_order_relaxed);
+  if (n == 0)
+    n = 1;
+  void* p = nullptr;
+#ifdef _WIN32
+  p = _aligned_malloc(n, align);
+#else
+  if (posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, n) != 0)
+    p = nullptr;
+#endif
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+static void BenchFree(void* p) noexcept
+{
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+void* operator new(size_t n) { return BenchMalloc(n, alignof(std::max_align_t)); }
+void* operator new[](size_t n) { return BenchMalloc(n, alignof(std::max_align_t)); }
+void* operator new(size_t n, std::align_val_t a) { return BenchMalloc(n, size_t(a)); }
+void* operator new[](size_t n, std::align_val_t a) { return BenchMalloc(n, size_t(a)); }
+void operator delete(void* p) noexcept { BenchFree(p); }
+void operator delete[](void* p) noexcept { BenchFree(p); }
+void operator delete(void* p, size_t) noexcept { BenchFree(p); }
+void operator delete[](void* p, size_t) noexcept { BenchFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { BenchFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { BenchFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { BenchFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { BenchFree(p); }
+
+size_t BenchAllocCount()
+{
+  return allocCount.load(std::memory_order_relaxed);
+}
+
+size_t BenchAllocBytes()
+{
+  return allocBytes.load(std::memory_order_relaxed);
+}
+
+std::string BenchId(const std::string& name, const std::string& type, size_t n)
+{
+  return name + "/" + type + "/" + std::to_string(n);
+}
+
+double BenchMedian(std::vector<double> v)
+{
+  if (v.empty())
+    return 0;
+  std::sort(v.begin(), v.end());
+  const size_t m = v.size() / 2;
+  return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2;
+}
+
+static double BenchMad(const std::vector<double>& v, double median)
+{
+  std::vector<double> dev;
+  for (double x : v)
+    dev.push_back(x > median ? x - median : median - x);
+  return 1.4826 * BenchMedian(dev);
+}
+
+double BenchRobustMedian(const std::vector<double>& v, double k)
+{
+  const double m = BenchMedian(v);
+  const double mad = BenchMad(v, m);
+  if (mad == 0)
+    return m;
+  std::vector<double> kept;
+  for (double x : v)
+    if (x >= m - k * mad && x <= m + k * mad)
+      kept.push_back(x);
+  return BenchMedian(kept);
+}
+
+double BenchRelativeSpread(const std::vector<double>& v)
+{
+  const double m = BenchMedian(v);
+  return m > 0 ? BenchMad(v, m) / m : 0;
+}
+
+void TBenchSuite::Add(const std::string& name, const std::string& type, size_t n, double flops, double bytes,
+  std::function<std::function<void()>()> make)
+{
+  cases.push_back(TBenchCase{ name, type, n, flops, bytes, std::move(make) });
+}
+
+TBenchSuite TBenchSuite::Select(const std::vector<std::string>& ids, std::vector<std::string>* missing) const
+{
+  TBenchSuite res;
+  for (const std::string& id : ids)
+  {
+    auto it = std::find_if(cases.begin(), cases.end(), [&id](const TBenchCase& c) { return BenchId(c.name, c.type, c.n) == id; });
+    if (it != cases.end())
+      res.cases.push_back(*it);
+    else if (missing != nullptr)
+      missing->push_back(id);
+  }
+  return res;
+}
+
+typedef std::chrono::steady_clock TBenchClock;
+
+static double BenchSeconds(const std::function<void()>& op, size_t iters)
+{
+  const TBenchClock::time_point t0 = TBenchClock::now();
+  for (size_t i = 0; i < iters; i++)
+    op();
+  return std::chrono::duration<double>(TBenchClock::now() - t0).count();
+}
+
+// Число повторений операции в одном повторе: удвоение до ~1/10 времени
+// повтора, затем пересчет по измеренной скорости
+static size_t BenchCalibrate(const std::function<void()>& op, double batchTime)
+{
+  size_t iters = 1;
+  double t = BenchSeconds(op, iters);
+  while (t < batchTime / 10 && iters < (size_t(1) << 30))
+  {
+    iters *= 2;
+    t = BenchSeconds(op, iters);
+  }
+  const double perOp = t / double(iters);
+  const double want = perOp > 0 ? batchTime / perOp : double(iters);
+  return want < 1 ? 1 : size_t(want);
+}
+
+std::vector<TBenchResult> TBenchSuite::Run(const TBenchOptions& opt, std::ostream* progress) const
+{
+  std::vector<TBenchResult> results;
+  const size_t repeats = opt.repeats == 0 ? 1 : opt.repeats;
+  for (const TBenchCase& c : cases)
+  {
+    if (!opt.filter.empty() && BenchId(c.name, c.type, c.n).find(opt.filter) == std::string::npos)
+      continue;
+    const std::function<void()> op = c.make();
+    op();
+    const size_t iters = BenchCalibrate(op, opt.minTime / double(repeats));
+
+    TBenchResult r;
+    r.name = c.name;
+    r.type = c.type;
+    r.n = c.n;
+    r.iterations = iters;
+    const size_t count0 = BenchAllocCount(), bytes0 = BenchAllocBytes();
+    for (size_t k = 0; k < repeats; k++)
+      r.samples.push_back(BenchSeconds(op, iters) * 1e9 / double(iters));
+    const double ops = double(iters) * double(repeats);
+    r.allocsPerOp = double(BenchAllocCount() - count0) / ops;
+    r.allocBytesPerOp = double(BenchAllocBytes() - bytes0) / ops;
+    r.nsPerOp = BenchMedian(r.samples);
+    r.nsPerOpMin = *std::min_element(r.samples.begin(), r.samples.end());
+    r.gflops = r.nsPerOp > 0 ? c.flops / r.nsPerOp : 0;
+    r.gbps = r.nsPerOp > 0 ? c.bytes / r.nsPerOp : 0;
+    results.push_back(r);
+    if (progress != nullptr)
+      BenchPrintRow(*progress, r);
+  }
+  return results;
+}
+
+void BenchPrintHeader(std::ostream& os)
+{
+  os << std::left << std::setw(28) << "benchmark" << std::setw(8) << "type" << std::right
+    << std::setw(9) << "n" << std::setw(14) << "ns/op" << std::setw(10) << "GFLOP/s"
+    << std::setw(10) << "GB/s" << std::setw(11) << "allocs/op" << std::endl;
+}
+
+void BenchPrintRow(std::ostream& os, const TBenchResult& r)
+{
+  os << std::left << std::setw(28) << r.name << std::setw(8) << r.type << std::right
+    << std::setw(9) << r.n << std::fixed << std::setprecision(1) << std::setw(14) << r.nsPerOp
+    << std::setprecision(2) << std::setw(10) << r.gflops << std::setw(10) << r.gbps
+    << std::setw(11) << r.allocsPerOp << std::defaultfloat << std::endl;
+}
+
+void BenchWriteJson(std::ostream& os, const std::vector<TBenchResult>& results)
+{
+  os << "{\n  \"context\": { \"threads\": " << ParallelThreadCount()
+    << ", \"simd\": \"" << SimdKernelSetName() << "\" },\n  \"benchmarks\": [";
+  os << std::setprecision(6);
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    const TBenchResult& r = results[i];
+    os << (i ? ",\n" : "\n") << "    { \"name\": \"" << r.name << "\", \"type\": \"" << r.type
+      << "\", \"n\": " << r.n << ", \"iterations\": " << r.iterations
+      << ", \"ns_per_op\": " << r.nsPerOp << ", \"ns_per_op_min\": " << r.nsPerOpMin
+      << ", \"gflops\": " << r.gflops << ", \"gbps\": " << r.gbps
+      << ", \"allocs_per_op\": " << r.allocsPerOp << ", \"alloc_bytes_per_op\": " << r.allocBytesPerOp
+      << ", \"samples\": [";
+    for (size_t k = 0; k < r.samples.size(); k++)
+      os << (k ? ", " : "") << r.samples[k];
+    os << "] }";
+  }
+  os << "\n  ]\n}\n";
+}
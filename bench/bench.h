@@ -0,0 +1,105 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Измерение скорости операций библиотеки
+
+#ifndef __TBench_H__
+#define __TBench_H__
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Замер: make() готовит данные (не измеряется) и возвращает операцию,
+// которую замер повторяет. flops и bytes - модель одной операции
+// (арифметика и обязательный обмен с памятью: чтение операндов и запись
+// результата), по ним считаются GFLOP/s и GB/s
+struct TBenchCase
+{
+  std::string name;
+  std::string type;
+  size_t n;
+  double flops;
+  double bytes;
+  std::function<std::function<void()>()> make;
+};
+
+struct TBenchOptions
+{
+  // время всех повторов одного замера
+  double minTime = 0.2;
+  size_t repeats = 5;
+  std::string filter;
+};
+
+// Результат: время одной операции в каждом повторе и его медиана,
+// выделения памяти через operator new в пересчете на одну операцию
+struct TBenchResult
+{
+  std::string name;
+  std::string type;
+  size_t n;
+  size_t iterations;
+  std::vector<double> samples;
+  double nsPerOp;
+  double nsPerOpMin;
+  double gflops;
+  double gbps;
+  double allocsPerOp;
+  double allocBytesPerOp;
+};
+
+class TBenchSuite
+{
+  std::vector<TBenchCase> cases;
+public:
+  void Add(const std::string& name, const std::string& type, size_t n, double flops, double bytes,
+    std::function<std::function<void()>()> make);
+  const std::vector<TBenchCase>& Cases() const { return cases; }
+  // набор из замеров с полными именами ids (в порядке ids);
+  // имена, которых нет в наборе, возвращаются в missing
+  TBenchSuite Select(const std::vector<std::string>& ids, std::vector<std::string>* missing = nullptr) const;
+
+  // выполнение замеров, имя которых (name/type/n) содержит opt.filter;
+  // progress (если задан) получает строку таблицы после каждого замера
+  std::vector<TBenchResult> Run(const TBenchOptions& opt, std::ostream* progress = nullptr) const;
+};
+
+// Счетчики operator new (заменен в bench.cpp)
+size_t BenchAllocCount();
+size_t BenchAllocBytes();
+
+// Полное имя замера: name/type/n
+std::string BenchId(const std::string& name, const std::string& type, size_t n);
+
+double BenchMedian(std::vector<double> v);
+// Медиана после отбрасывания выбросов: значений дальше k * MAD от медианы
+// (MAD - медиана абсолютных отклонений, приведенная к стандартному отклонению)
+double BenchRobustMedian(const std::vector<double>& v, double k = 3);
+// Относительный разброс: MAD / медиана
+double BenchRelativeSpread(const std::vector<double>& v);
+
+void BenchPrintHeader(std::ostream& os);
+void BenchPrintRow(std::ostream& os, const TBenchResult& r);
+void BenchWriteJson(std::ostream& os, const std::vector<TBenchResult>& results);
+
+// Значение, которое компилятор должен считать использованным
+template<typename T>
+inline void BenchKeep(const T& x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r"(&x) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &x;
+#endif
+}
+
+// Полный набор замеров библиотеки (bench_suite.cpp): векторы длины
+// vectorSizes и матрицы порядка matrixSizes для float, double и int
+void BenchAddLibrary(TBenchSuite& suite, const std::vector<size_t>& vectorSizes, const std::vector<size_t>& matrixSizes);
+
+#endif
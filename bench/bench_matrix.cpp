@@ -0,0 +1,94 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Замеры скорости операций библиотеки:
+//   bench_matrix [--quick] [--filter <s>] [--json <file>]
+//                [--min-time <sec>] [--repeats <n>] [--threads <n>]
+
+#include "bench.h"
+#include "tparallel.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static void Usage()
+{
+  cerr << "usage: bench_matrix [--quick] [--filter <s>] [--json <file>]" << endl
+    << "                    [--min-time <sec>] [--repeats <n>] [--threads <n>]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  TBenchOptions opt;
+  string json;
+  bool quick = false;
+  for (int i = 1; i < argc; i++)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--quick") == 0)
+      quick = true;
+    else if (strcmp(argv[i], "--filter") == 0 && hasValue)
+      opt.filter = argv[++i];
+    else if (strcmp(argv[i], "--json") == 0 && hasValue)
+      json = argv[++i];
+    else if (strcmp(argv[i], "--min-time") == 0 && hasValue)
+      opt.minTime = atof(argv[++i]);
+    else if (strcmp(argv[i], "--repeats") == 0 && hasValue)
+      opt.repeats = size_t(atoi(argv[++i]));
+    else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+      ParallelSetThreadCount(size_t(atoi(argv[++i])));
+    else
+    {
+      Usage();
+      return 1;
+    }
+  }
+
+  // --quick - малые размеры и короткие замеры (проверка сборки и прогона)
+  vector<size_t> vectorSizes = { 1 << 10, 1 << 16, 1 << 20 };
+  vector<size_t> matrixSizes = { 32, 128, 512 };
+  if (quick)
+  {
+    vectorSizes = { 1 << 10 };
+    matrixSizes = { 32 };
+    opt.minTime = 0.02;
+    opt.repeats = 3;
+  }
+
+  TBenchSuite suite;
+  BenchAddLibrary(suite, vectorSizes, matrixSizes);
+
+  BenchPrintHeader(cout);
+  vector<TBenchResult> results;
+  try
+  {
+    results = suite.Run(opt, &cout);
+  }
+  catch (const char* e)
+  {
+    cerr << "error: " << e << endl;
+    return 1;
+  }
+  catch (const exception& e)
+  {
+    cerr << "error: " << e.what() << endl;
+    return 1;
+  }
+
+  if (!json.empty())
+  {
+    ofstream out(json);
+    if (!out)
+    {
+      cerr << "error: cannot write " << json << endl;
+      return 1;
+    }
+    BenchWriteJson(out, results);
+  }
+  return 0;
+}
@@ -0,0 +1,284 @@
+#include "bench.h"
+#include "tmatrix.h"
+#include "TUTriangleMatrix.h"
+#include "TDTriangleMatrix.h"
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Данные замеров: значения без нулей (деление), матрицы с преобладающей
+// диагональю (LU без вырождения)
+template<typename T>
+static TDynamicVector<T> BenchVector(size_t n, size_t seed = 0)
+{
+  TDynamicVector<T> v(n);
+  for (size_t i = 0; i < n; i++)
+    v[i] = T((i + seed) % 7 + 1);
+  return v;
+}
+
+template<typename T>
+static T BenchElement(size_t i, size_t j, size_t n)
+{
+  return T(int((i * 7 + j * 3) % 11) - 5) + (i == j ? T(8 * n) : T());
+}
+
+template<typename T>
+static TDynamicMatrix<T> BenchMatrix(size_t n)
+{
+  TDynamicMatrix<T> m(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      m[i][j] = BenchElement<T>(i, j, n);
+  return m;
+}
+
+// Матрица для LU-разложения: для целых T - a(i, j) = min(i, j) + 1 = L * L^T
+// (L - нижняя треугольная из единиц): все ведущие миноры равны 1, поэтому
+// значения шагов Барейса не превышают n, а обратная матрица целая
+template<typename T>
+static TDynamicMatrix<T> BenchLUMatrix(size_t n)
+{
+  if constexpr (std::is_integral<T>::value)
+  {
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = 0; j < n; j++)
+        m[i][j] = T((i < j ? i : j) + 1);
+    return m;
+  }
+  else
+    return BenchMatrix<T>(n);
+}
+
+// Текст контейнера для замеров ввода
+template<typename C>
+static std::string BenchText(const C& c)
+{
+  std::ostringstream os;
+  os << c;
+  return os.str();
+}
+
+template<typename T>
+static TUTriangleMatrix<T> BenchUTriangle(size_t n)
+{
+  TUTriangleMatrix<T> m(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = i; j < n; j++)
+      m(i, j) = BenchElement<T>(i, j, n);
+  return m;
+}
+
+template<typename T>
+static TDTriangleMatrix<T> BenchDTriangle(size_t n)
+{
+  TDTriangleMatrix<T> m(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j <= i; j++)
+      m(i, j) = BenchElement<T>(i, j, n);
+  return m;
+}
+
+template<typename T> const char* BenchTypeName();
+template<> const char* BenchTypeName<float>() { return "float"; }
+template<> const char* BenchTypeName<double>() { return "double"; }
+template<> const char* BenchTypeName<int>() { return "int"; }
+
+template<typename T>
+static void BenchAddVector(TBenchSuite& suite, size_t n)
+{
+  typedef TDynamicVector<T> V;
+  const double e = double(n), s = sizeof(T);
+  auto add = [&](const char* name, double flops, double bytes, std::function<std::function<void()>()> make)
+  {
+    suite.Add(name, BenchTypeName<T>(), n, flops, bytes, std::move(make));
+  };
+
+  add("vector.ctor", 0, e * s, [n] { return [n] { V v(n, T(1)); BenchKeep(v); }; });
+  add("vector.ctor_array", 0, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V v(&a[0], a.size()); BenchKeep(v); }; });
+  add("vector.ctor_uninit", 0, 0, [n] { return [n] { V v(n, TUninitialized()); BenchKeep(v); }; });
+  add("vector.copy", 0, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V v(a); BenchKeep(v); }; });
+  add("vector.move", 0, 0, [n] { V a = BenchVector<T>(n); return [a]() mutable { V v(std::move(a)); a = std::move(v); BenchKeep(a); }; });
+  add("vector.assign", 0, 2 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b]() mutable { a = b; BenchKeep(a); }; });
+  add("vector.index", e, e * s, [n] { V a = BenchVector<T>(n); return [a] { T r = T(); for (size_t i = 0; i < a.size(); i++) r = r + a[i]; BenchKeep(r); }; });
+  add("vector.at", e, e * s, [n] { V a = BenchVector<T>(n); return [a] { T r = T(); for (size_t i = 0; i < a.size(); i++) r = r + a.at(i); BenchKeep(r); }; });
+  add("vector.equal", 0, 2 * e * s, [n] { V a = BenchVector<T>(n), b(a); return [a, b] { bool r = a == b; BenchKeep(r); }; });
+  add("vector.not_equal", 0, 2 * e * s, [n] { V a = BenchVector<T>(n), b(a); return [a, b] { bool r = a != b; BenchKeep(r); }; });
+  add("vector.add", e, 3 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b] { V r = a + b; BenchKeep(r); }; });
+  add("vector.sub", e, 3 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b] { V r = a - b; BenchKeep(r); }; });
+  add("vector.neg", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V r = -a; BenchKeep(r); }; });
+  add("vector.add_scalar", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V r = a + T(3); BenchKeep(r); }; });
+  add("vector.sub_scalar", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V r = a - T(3); BenchKeep(r); }; });
+  add("vector.mul_scalar", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V r = a * T(3); BenchKeep(r); }; });
+  add("vector.div_scalar", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a] { V r = a / T(3); BenchKeep(r); }; });
+  add("vector.expr", 3 * e, 4 * e * s, [n]
+  {
+    V a = BenchVector<T>(n), b = BenchVector<T>(n, 1), c = BenchVector<T>(n, 2);
+    return [a, b, c] { V r = a + b * T(2) - c; BenchKeep(r); };
+  });
+  add("vector.dot", 2 * e, 2 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b] { T r = a * b; BenchKeep(r); }; });
+  add("vector.add_assign", e, 3 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b]() mutable { a += b; BenchKeep(a); }; });
+  add("vector.sub_assign", e, 3 * e * s, [n] { V a = BenchVector<T>(n), b = BenchVector<T>(n, 1); return [a, b]() mutable { a -= b; BenchKeep(a); }; });
+  add("vector.add_scalar_assign", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a]() mutable { a += T(0); BenchKeep(a); }; });
+  add("vector.sub_scalar_assign", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a]() mutable { a -= T(0); BenchKeep(a); }; });
+  add("vector.mul_scalar_assign", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a]() mutable { a *= T(1); BenchKeep(a); }; });
+  add("vector.div_scalar_assign", e, 2 * e * s, [n] { V a = BenchVector<T>(n); return [a]() mutable { a /= T(1); BenchKeep(a); }; });
+  add("vector.write", 0, e * s, [n] { V a = BenchVector<T>(n); return [a] { std::ostringstream os; os << a; BenchKeep(os); }; });
+  add("vector.read", 0, e * s, [n]
+  {
+    V a(n);
+    const std::string text = BenchText(BenchVector<T>(n));
+    return [a, text]() mutable { std::istringstream is(text); is >> a; BenchKeep(a); };
+  });
+}
+
+template<typename T>
+static void BenchAddMatrix(TBenchSuite& suite, size_t n)
+{
+  typedef TDynamicMatrix<T> M;
+  typedef TDynamicVector<T> V;
+  const double d = double(n), e = d * d, s = sizeof(T);
+  auto add = [&](const char* name, double flops, double bytes, std::function<std::function<void()>()> make)
+  {
+    suite.Add(name, BenchTypeName<T>(), n, flops, bytes, std::move(make));
+  };
+
+  add("matrix.ctor", 0, e * s, [n] { return [n] { M m(n, T(1)); BenchKeep(m); }; });
+  add("matrix.copy", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a] { M m(a); BenchKeep(m); }; });
+  add("matrix.assign", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b]() mutable { a = b; BenchKeep(a); }; });
+  add("matrix.index", e, e * s, [n]
+  {
+    M a = BenchMatrix<T>(n);
+    return [a] { T r = T(); for (size_t i = 0; i < a.size(); i++) for (size_t j = 0; j < a.size(); j++) r = r + a[i][j]; BenchKeep(r); };
+  });
+  add("matrix.at", e, e * s, [n]
+  {
+    M a = BenchMatrix<T>(n);
+    return [a] { T r = T(); for (size_t i = 0; i < a.size(); i++) for (size_t j = 0; j < a.size(); j++) r = r + a.at(i).at(j); BenchKeep(r); };
+  });
+  add("matrix.equal", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b] { bool r = a == b; BenchKeep(r); }; });
+  add("matrix.not_equal", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b] { bool r = a != b; BenchKeep(r); }; });
+  add("matrix.add", e, 3 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b] { M r = a + b; BenchKeep(r); }; });
+  add("matrix.sub", e, 3 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b] { M r = a - b; BenchKeep(r); }; });
+  add("matrix.neg", e, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a] { M r = -a; BenchKeep(r); }; });
+  add("matrix.mul_scalar", e, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a] { M r = a * T(3); BenchKeep(r); }; });
+  add("matrix.div_scalar", e, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a] { M r = a / T(3); BenchKeep(r); }; });
+  add("matrix.add_assign", e, 3 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b]() mutable { a += b; BenchKeep(a); }; });
+  add("matrix.sub_assign", e, 3 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b]() mutable { a -= b; BenchKeep(a); }; });
+  add("matrix.mul_scalar_assign", e, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a]() mutable { a *= T(1); BenchKeep(a); }; });
+  add("matrix.div_scalar_assign", e, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a]() mutable { a /= T(1); BenchKeep(a); }; });
+  add("matrix.mul_vector", 2 * e, (e + 2 * d) * s, [n] { M a = BenchMatrix<T>(n); V v = BenchVector<T>(n); return [a, v] { V r = a * v; BenchKeep(r); }; });
+  add("matrix.mul_matrix", 2 * e * d, 3 * e * s, [n] { M a = BenchMatrix<T>(n), b(a); return [a, b] { M r = a * b; BenchKeep(r); }; });
+  add("matrix.mul_assign", 2 * e * d, 3 * e * s, [n]
+  {
+    // произведение на единичную матрицу не меняет значений между повторами
+    M a = BenchMatrix<T>(n), id(n);
+    for (size_t i = 0; i < n; i++)
+      id[i][i] = T(1);
+    return [a, id]() mutable { a *= id; BenchKeep(a); };
+  });
+  add("matrix.transpose", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n); return [a]() mutable { a.Transpose(); BenchKeep(a); }; });
+  add("matrix.transposed", 0, 2 * e * s, [n] { M a = BenchMatrix<T>(n), b(n); return [a, b]() mutable { a.Transposed(b); BenchKeep(b); }; });
+  add("matrix.cofactor", 0, 2 * (d - 1) * (d - 1) * s, [n] { M a = BenchMatrix<T>(n); return [a] { M r = a.Cofactor(0, 0); BenchKeep(r); }; });
+  add("matrix.write", 0, e * s, [n] { M a = BenchMatrix<T>(n); return [a] { std::ostringstream os; os << a; BenchKeep(os); }; });
+  add("matrix.read", 0, e * s, [n]
+  {
+    M a(n);
+    const std::string text = BenchText(BenchMatrix<T>(n));
+    return [a, text]() mutable { std::istringstream is(text); is >> a; BenchKeep(a); };
+  });
+
+  // LU-разложение и решения (для целых T - метод Барейса на BenchLUMatrix)
+  const double lu = 2 * e * d / 3;
+  add("matrix.det", lu, 2 * e * s, [n] { M a = BenchLUMatrix<T>(n); return [a] { T r = a.Det(); BenchKeep(r); }; });
+  add("matrix.minor", 2 * (d - 1) * (d - 1) * (d - 1) / 3, 2 * (d - 1) * (d - 1) * s, [n] { M a = BenchLUMatrix<T>(n); return [a] { T r = a.Minor(0, 0); BenchKeep(r); }; });
+  add("matrix.invertible", lu + 2 * e * d, 3 * e * s, [n] { M a = BenchLUMatrix<T>(n); return [a] { M r = a.Invertible(); BenchKeep(r); }; });
+  add("matrix.div", lu + 2 * e * d, 5 * e * s, [n] { M a = BenchLUMatrix<T>(n), b(a); return [a, b] { M r = a / b; BenchKeep(r); }; });
+  add("matrix.solve_vector", lu + 2 * e, (2 * e + 2 * d) * s, [n] { M a = BenchLUMatrix<T>(n); V v = BenchVector<T>(n); return [a, v] { V r = Solve(a, v); BenchKeep(r); }; });
+  add("matrix.solve_matrix", lu + 2 * e * d, 4 * e * s, [n] { M a = BenchLUMatrix<T>(n), b(a); return [a, b] { M r = Solve(a, b); BenchKeep(r); }; });
+}
+
+// Общие замеры треугольных матриц; Tri - TUTriangleMatrix или TDTriangleMatrix
+template<typename T, typename Tri>
+static void BenchAddTriangle(TBenchSuite& suite, size_t n, const char* prefix, Tri(*make)(size_t))
+{
+  typedef TDynamicVector<T> V;
+  typedef TDynamicMatrix<T> M;
+  const double d = double(n), e = d * (d + 1) / 2, s = sizeof(T);
+  const std::string p(prefix);
+  auto add = [&](const char* name, double flops, double bytes, std::function<std::function<void()>()> f)
+  {
+    suite.Add(p + name, BenchTypeName<T>(), n, flops, bytes, std::move(f));
+  };
+
+  add(".ctor", 0, e * s, [n] { return [n] { Tri m(n, T(1)); BenchKeep(m); }; });
+  add(".copy", 0, 2 * e * s, [n, make] { Tri a = make(n); return [a] { Tri m(a); BenchKeep(m); }; });
+  add(".equal", 0, 2 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b] { bool r = a == b; BenchKeep(r); }; });
+  add(".not_equal", 0, 2 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b] { bool r = a != b; BenchKeep(r); }; });
+  add(".at", e, e * s, [n, make]
+  {
+    Tri a = make(n);
+    return [a]
+    {
+      T r = T();
+      for (size_t i = 0; i < a.size(); i++)
+        for (size_t j = 0; j < a.size(); j++)
+          if (std::is_same<Tri, TUTriangleMatrix<T>>::value ? j >= i : j <= i)
+            r = r + a.at(i, j);
+      BenchKeep(r);
+    };
+  });
+  add(".add", e, 3 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b] { Tri r = a + b; BenchKeep(r); }; });
+  add(".sub", e, 3 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b] { Tri r = a - b; BenchKeep(r); }; });
+  add(".neg", e, 2 * e * s, [n, make] { Tri a = make(n); return [a] { Tri r = -a; BenchKeep(r); }; });
+  add(".mul_scalar", e, 2 * e * s, [n, make] { Tri a = make(n); return [a] { Tri r = a * T(3); BenchKeep(r); }; });
+  add(".div_scalar", e, 2 * e * s, [n, make] { Tri a = make(n); return [a] { Tri r = a / T(3); BenchKeep(r); }; });
+  add(".add_assign", e, 3 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b]() mutable { a += b; BenchKeep(a); }; });
+  add(".sub_assign", e, 3 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b]() mutable { a -= b; BenchKeep(a); }; });
+  add(".mul_scalar_assign", e, 2 * e * s, [n, make] { Tri a = make(n); return [a]() mutable { a *= T(1); BenchKeep(a); }; });
+  add(".div_scalar_assign", e, 2 * e * s, [n, make] { Tri a = make(n); return [a]() mutable { a /= T(1); BenchKeep(a); }; });
+  add(".mul_vector", 2 * e, (e + 2 * d) * s, [n, make] { Tri a = make(n); V v = BenchVector<T>(n); return [a, v] { V r = a * v; BenchKeep(r); }; });
+  add(".mul_matrix", d * (d + 1) * (d + 2) / 3, 3 * e * s, [n, make] { Tri a = make(n), b(a); return [a, b] { Tri r = a * b; BenchKeep(r); }; });
+  add(".mul_assign", d * (d + 1) * (d + 2) / 3, 3 * e * s, [n]
+  {
+    Tri id(n);
+    for (size_t i = 0; i < n; i++)
+      id(i, i) = T(1);
+    Tri a = id;
+    return [a, id]() mutable { a *= id; BenchKeep(a); };
+  });
+  // для целых T решение округляется к нулю на каждом шаге, переполнения нет
+  add(".solve_vector", d * d, (e + 2 * d) * s, [n, make] { Tri a = make(n); V v = BenchVector<T>(n); return [a, v] { V r = a.Solve(v); BenchKeep(r); }; });
+  add(".solve_matrix", d * d * d, (e + 2 * d * d) * s, [n, make] { Tri a = make(n); M b = BenchMatrix<T>(n); return [a, b] { M r = a.Solve(b); BenchKeep(r); }; });
+  add(".write", 0, e * s, [n, make] { Tri a = make(n); return [a] { std::ostringstream os; os << a; BenchKeep(os); }; });
+  add(".read", 0, e * s, [n]
+  {
+    // вывод дополняет строки нулями, ввод читает только элементы строк
+    Tri a(n);
+    const std::string text = BenchText(BenchVector<T>(n * (n + 1) / 2));
+    return [a, text]() mutable { std::istringstream is(text); is >> a; BenchKeep(a); };
+  });
+}
+
+template<typename T>
+static void BenchAddType(TBenchSuite& suite, const std::vector<size_t>& vectorSizes, const std::vector<size_t>& matrixSizes)
+{
+  for (size_t n : vectorSizes)
+    BenchAddVector<T>(suite, n);
+  for (size_t n : matrixSizes)
+    BenchAddMatrix<T>(suite, n);
+  for (size_t n : matrixSizes)
+    BenchAddTriangle<T>(suite, n, "utmatrix", &BenchUTriangle<T>);
+  for (size_t n : matrixSizes)
+    BenchAddTriangle<T>(suite, n, "dtmatrix", &BenchDTriangle<T>);
+}
+
+void BenchAddLibrary(TBenchSuite& suite, const std::vector<size_t>& vectorSizes, const std::vector<size_t>& matrixSizes)
+{
+  BenchAddType<float>(suite, vectorSizes, matrixSizes);
+  BenchAddType<double>(suite, vectorSizes, matrixSizes);
+  BenchAddType<int>(suite, vectorSizes, matrixSizes);
+}
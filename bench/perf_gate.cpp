@@ -0,0 +1,334 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Проверка регрессий скорости: фиксированный набор замеров сравнивается
+// с сохраненной базой (baseline.txt)
+//   perf_gate_matrix [--baseline <file>] [--update] [--json <file>]
+//                    [--min-time <sec>] [--repeats <n>] [--retries <n>]
+//                    [--threads <n>]
+// Код возврата: 0 - регрессий нет, 1 - есть регрессия, 2 - ошибка запуска,
+// 3 - база снята в другом контексте (процессор, набор SIMD, компилятор,
+// тип сборки, потоки): абсолютные времена несравнимы, проверка пропущена
+// (новая база для этой машины - --update)
+
+#include "bench.h"
+#include "tparallel.h"
+#include "tsimd.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+#ifndef PERF_BASELINE
+#define PERF_BASELINE "baseline.txt"
+#endif
+
+// Набор проверки: основные ядра каждого контейнера; размеры векторов
+// GATE_VECTOR_SIZE, матриц - GATE_MATRIX_SIZES
+const size_t GATE_VECTOR_SIZE = 1 << 16;
+static const vector<size_t> GATE_MATRIX_SIZES = { 128, 256 };
+static const vector<string> GATE_IDS = {
+  "vector.add/double/65536",
+  "vector.expr/double/65536",
+  "vector.dot/double/65536",
+  "vector.add_assign/double/65536",
+  "vector.mul_scalar/int/65536",
+  "matrix.add/double/256",
+  "matrix.mul_vector/double/256",
+  "matrix.mul_matrix/double/256",
+  "matrix.mul_matrix/float/256",
+  "matrix.mul_matrix/int/128",
+  "matrix.transpose/double/256",
+  "matrix.det/double/128",
+  "matrix.invertible/double/128",
+  "matrix.solve_matrix/double/128",
+  "utmatrix.mul_vector/double/256",
+  "utmatrix.mul_matrix/double/128",
+  "utmatrix.solve_vector/double/256",
+  "dtmatrix.mul_matrix/double/128",
+  "dtmatrix.solve_matrix/double/128",
+};
+
+// Порог по умолчанию для новых записей базы: три относительных разброса,
+// измеренных при обновлении, в пределах [15%, 25%]; пороги существующих
+// записей при обновлении сохраняются (их можно править в файле вручную)
+const double GATE_MIN_THRESHOLD = 0.15;
+const double GATE_MAX_THRESHOLD = 0.25;
+const double GATE_SPREAD_FACTOR = 3;
+// База строится по объединенным повторам GATE_UPDATE_ROUNDS прогонов
+const size_t GATE_UPDATE_ROUNDS = 3;
+// Число потоков замеров (записывается в контекст базы): одинаковое на
+// любой машине, иначе сравниваются разные конфигурации
+const size_t GATE_THREADS = 1;
+
+struct TGateEntry
+{
+  double nsPerOp;
+  double threshold;
+};
+
+// Формат базы: строки "<benchmark> <ns/op> <threshold>", '#' - комментарий
+static bool ReadBaseline(const string& path, map<string, TGateEntry>& base, string& context)
+{
+  ifstream in(path);
+  if (!in)
+    return false;
+  string line;
+  while (getline(in, line))
+  {
+    if (line.compare(0, 9, "# context") == 0)
+    {
+      const size_t pos = line.find_first_not_of(' ', 9);
+      context = pos == string::npos ? string() : line.substr(pos);
+    }
+    if (line.empty() || line[0] == '#')
+      continue;
+    istringstream ls(line);
+    string id;
+    TGateEntry e;
+    if (ls >> id >> e.nsPerOp >> e.threshold)
+      base[id] = e;
+  }
+  return true;
+}
+
+// Код возврата, когда база снята в другом контексте
+const int GATE_SKIPPED = 3;
+
+// Модель процессора (пробелы заменены на '_'), "unknown" - если неизвестна
+static string GateCpuName()
+{
+  string name;
+#if defined(__linux__)
+  ifstream in("/proc/cpuinfo");
+  string line;
+  while (name.empty() && getline(in, line))
+    if (line.compare(0, 10, "model name") == 0)
+    {
+      const size_t colon = line.find(':');
+      const size_t pos = colon == string::npos ? string::npos : line.find_first_not_of(' ', colon + 1);
+      if (pos != string::npos)
+        name = line.substr(pos);
+    }
+#endif
+  if (name.empty())
+    return "unknown";
+  for (char& c : name)
+    if (c == ' ' || c == '\t')
+      c = '_';
+  return name;
+}
+
+static string GateCompilerName()
+{
+#if defined(__clang__)
+  return "clang-" + to_string(__clang_major__) + "." + to_string(__clang_minor__);
+#elif defined(__GNUC__)
+  return "gcc-" + to_string(__GNUC__) + "." + to_string(__GNUC_MINOR__);
+#elif defined(_MSC_VER)
+  return "msvc-" + to_string(_MSC_VER);
+#else
+  return "unknown";
+#endif
+}
+
+// Контекст замеров: база сравнима только с замерами в том же контексте
+static string GateContext()
+{
+#ifdef NDEBUG
+  const char* build = "release";
+#else
+  const char* build = "debug";
+#endif
+  return string("cpu=") + GateCpuName() + " simd=" + SimdKernelSetName() + " compiler=" + GateCompilerName()
+    + " build=" + build + " threads=" + to_string(ParallelThreadCount());
+}
+
+static bool WriteBaseline(const string& path, const vector<TBenchResult>& results, const map<string, TGateEntry>& old)
+{
+  ofstream out(path);
+  if (!out)
+    return false;
+  out << "# perf_gate baseline: <benchmark> <ns/op> <threshold>" << endl
+    << "# threshold - допустимое относительное замедление (0.10 = 10%)" << endl
+    << "# context " << GateContext() << endl;
+  for (const TBenchResult& r : results)
+  {
+    const string id = BenchId(r.name, r.type, r.n);
+    double threshold = GATE_MIN_THRESHOLD;
+    auto it = old.find(id);
+    if (it != old.end())
+      threshold = it->second.threshold;
+    else
+      threshold = min(GATE_MAX_THRESHOLD, max(threshold, ceil(GATE_SPREAD_FACTOR * BenchRelativeSpread(r.samples) * 100) / 100));
+    out << left << setw(36) << id << right << fixed << setprecision(1) << setw(14) << BenchRobustMedian(r.samples)
+      << setprecision(2) << setw(7) << threshold << defaultfloat << endl;
+  }
+  return true;
+}
+
+static void Usage()
+{
+  cerr << "usage: perf_gate_matrix [--baseline <file>] [--update] [--json <file>]" << endl
+    << "                        [--min-time <sec>] [--repeats <n>] [--retries <n>]" << endl
+    << "                        [--threads <n>]" << endl;
+}
+
+int main(int argc, char** argv)
+{
+  string baselinePath = PERF_BASELINE, json;
+  bool update = false;
+  size_t retries = 2, threads = GATE_THREADS;
+  TBenchOptions opt;
+  opt.minTime = 0.5;
+  opt.repeats = 9;
+  for (int i = 1; i < argc; i++)
+  {
+    const bool hasValue = i + 1 < argc;
+    if (strcmp(argv[i], "--update") == 0)
+      update = true;
+    else if (strcmp(argv[i], "--baseline") == 0 && hasValue)
+      baselinePath = argv[++i];
+    else if (strcmp(argv[i], "--json") == 0 && hasValue)
+      json = argv[++i];
+    else if (strcmp(argv[i], "--min-time") == 0 && hasValue)
+      opt.minTime = atof(argv[++i]);
+    else if (strcmp(argv[i], "--repeats") == 0 && hasValue)
+      opt.repeats = size_t(atoi(argv[++i]));
+    else if (strcmp(argv[i], "--retries") == 0 && hasValue)
+      retries = size_t(atoi(argv[++i]));
+    else if (strcmp(argv[i], "--threads") == 0 && hasValue)
+      threads = size_t(atoi(argv[++i]));
+    else
+    {
+      Usage();
+      return 2;
+    }
+  }
+
+  ParallelSetThreadCount(threads);
+
+  map<string, TGateEntry> base;
+  string baseContext;
+  const bool haveBase = ReadBaseline(baselinePath, base, baseContext);
+  if (!haveBase && !update)
+  {
+    cerr << "error: cannot read baseline " << baselinePath << " (run with --update to create it)" << endl;
+    return 2;
+  }
+  if (haveBase && !update && baseContext != GateContext())
+  {
+    cerr << "skipped: baseline context '" << (baseContext.empty() ? string("unknown") : baseContext)
+      << "' differs from '" << GateContext() << "'" << endl
+      << "run with --update to record a baseline for this machine" << endl;
+    return GATE_SKIPPED;
+  }
+
+  TBenchSuite all;
+  BenchAddLibrary(all, { GATE_VECTOR_SIZE }, GATE_MATRIX_SIZES);
+  vector<string> missing;
+  const TBenchSuite suite = all.Select(GATE_IDS, &missing);
+  for (const string& id : missing)
+    cerr << "warning: unknown benchmark " << id << endl;
+
+  vector<TBenchResult> results;
+  try
+  {
+    results = suite.Run(opt);
+    // для базы - повторы нескольких прогонов (разброс между прогонами
+    // обычно больше, чем внутри одного)
+    for (size_t k = 1; update && k < GATE_UPDATE_ROUNDS; k++)
+    {
+      const vector<TBenchResult> more = suite.Run(opt);
+      for (size_t i = 0; i < results.size(); i++)
+        results[i].samples.insert(results[i].samples.end(), more[i].samples.begin(), more[i].samples.end());
+    }
+    // подтверждение: замеры, превысившие порог, повторяются до retries раз,
+    // остается лучшая медиана (кратковременная помеха не дает регрессию)
+    for (TBenchResult& r : results)
+    {
+      auto it = base.find(BenchId(r.name, r.type, r.n));
+      for (size_t k = 0; !update && k < retries && it != base.end()
+        && BenchRobustMedian(r.samples) > it->second.nsPerOp * (1 + it->second.threshold); k++)
+      {
+        const vector<TBenchResult> again = suite.Select({ it->first }).Run(opt);
+        if (BenchRobustMedian(again[0].samples) < BenchRobustMedian(r.samples))
+          r = again[0];
+      }
+    }
+  }
+  catch (const char* e)
+  {
+    cerr << "error: " << e << endl;
+    return 2;
+  }
+  catch (const exception& e)
+  {
+    cerr << "error: " << e.what() << endl;
+    return 2;
+  }
+
+  if (!json.empty())
+  {
+    ofstream out(json);
+    BenchWriteJson(out, results);
+  }
+  if (update)
+  {
+    if (!WriteBaseline(baselinePath, results, base))
+    {
+      cerr << "error: cannot write " << baselinePath << endl;
+      return 2;
+    }
+    cout << "baseline written to " << baselinePath << endl;
+    return 0;
+  }
+
+  // Таблица сравнения: время - медиана повторов без выбросов
+  size_t regressions = 0;
+  cout << left << setw(36) << "benchmark" << right << setw(14) << "baseline ns" << setw(14) << "current ns"
+    << setw(10) << "change" << setw(11) << "threshold" << "  status" << endl;
+  for (const TBenchResult& r : results)
+  {
+    const string id = BenchId(r.name, r.type, r.n);
+    const double cur = BenchRobustMedian(r.samples);
+    cout << left << setw(36) << id << right << fixed << setprecision(1);
+    auto it = base.find(id);
+    if (it == base.end())
+    {
+      cout << setw(14) << "-" << setw(14) << cur << setw(10) << "-" << setw(11) << "-" << "  new" << defaultfloat << endl;
+      continue;
+    }
+    const TGateEntry& e = it->second;
+    const double change = e.nsPerOp > 0 ? cur / e.nsPerOp - 1 : 0;
+    const char* status = "ok";
+    if (change > e.threshold)
+    {
+      status = "REGRESSION";
+      regressions++;
+    }
+    else if (change < -e.threshold)
+      status = "faster";
+    cout << setw(14) << e.nsPerOp << setw(14) << cur << showpos << setw(9) << change * 100 << "%"
+      << noshowpos << setw(10) << e.threshold * 100 << "%" << "  " << status << defaultfloat << endl;
+  }
+  for (const auto& b : base)
+    if (suite.Select({ b.first }).Cases().empty())
+      cout << left << setw(36) << b.first << right << "  (in baseline, not in gate set)" << endl;
+
+  if (regressions > 0)
+  {
+    cout << regressions << " benchmark(s) regressed" << endl;
+    return 1;
+  }
+  cout << "no regressions" << endl;
+  return 0;
+}
@@ -0,0 +1,490 @@
+// , ,  "   "
+//
+//
+//
+//
+
+#ifndef __TBandMatrix_H__
+#define __TBandMatrix_H__
+
+#include "tmatrix.h"
+#include <iostream>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+//   n x n  kl   ku .
+//   :  d ( -kl  ku)  n 
+// ,   DiagOffset(d),   (i, i + d)    i.
+//  ,    ( -d   d),
+//  
+template<typename T, typename A = TAlignedAllocator<T>>
+class TBandMatrix : private TDynamicVector<T, A>
+{
+protected:
+	using TDynamicVector<T, A>::pMem;
+	size_t sz;
+	size_t nLower, nUpper;
+
+	TBandMatrix(size_t s, size_t kl, size_t ku, TDynamicVector<T, A>&& data) noexcept : TDynamicVector<T, A>(std::move(data)), sz(s), nLower(kl), nUpper(ku) {}
+	static size_t CheckSize(size_t s, size_t kl, size_t ku);
+	size_t DiagOffset(ptrdiff_t d) const noexcept { return size_t(d + ptrdiff_t(nLower)) * sz; }
+	bool InBand(size_t i, size_t j) const noexcept { return j + nLower >= i && j <= i + nUpper; }
+	void ClearPadding();
+
+	// LU-    lu, perm[k] - ,   k;
+	//     0   
+	int FactorBand(TDynamicVector<T>& lu, TDynamicVector<size_t>& perm) const;
+	//   m   (b  x - n x m )
+	void SolveBand(const T* b, T* x, size_t m) const;
+	bool SolveThomas(const T* b, T* x, size_t m) const;
+
+	friend struct TExprAccess;
+public:
+	typedef T value_type;
+	typedef A allocator_type;
+
+	TBandMatrix(size_t s = 1, size_t kl = 0, size_t ku = 0, const T& val = T(), const A& alloc = A());
+	//    (texpr.h)   
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TBandMatrix>::value>::type>
+	TBandMatrix(const TExpr<E>& e) : TDynamicVector<T, A>(e, TExprFlat(), "bandmatrix.expr_construct"), sz(e.self().dim()), nLower(e.self().shape()), nUpper(e.self().count() / e.self().dim() - 1 - e.self().shape()) {}
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TBandMatrix>::value>::type>
+	TBandMatrix& operator=(const TExpr<E>& e);
+
+	size_t size() const noexcept { return sz; }
+	using TDynamicVector<T, A>::get_allocator;
+	size_t kl() const noexcept { return nLower; }
+	size_t ku() const noexcept { return nUpper; }
+
+	//  ;      ,
+	//    (   )
+	T& operator()(size_t i, size_t j);
+	T& at(size_t i, size_t j);
+	const T& operator()(size_t i, size_t j) const;
+	const T& at(size_t i, size_t j) const;
+
+	explicit operator TDynamicMatrix<T, A>() const;
+
+	T Det() const;
+
+	// 
+	bool operator==(const TBandMatrix& m) const noexcept;
+	bool operator!=(const TBandMatrix& m) const noexcept;
+
+	//  ,    -   (texpr.h)
+
+	//    
+	TBandMatrix& operator*=(const T& val);
+	TBandMatrix& operator/=(const T& val);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TBandMatrix, X>::value>::type>
+	TBandMatrix& operator+=(const X& m);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TBandMatrix, X>::value>::type>
+	TBandMatrix& operator-=(const X& m);
+
+	// - , O(n * (kl + ku + 1))
+	TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
+
+	//  : LU-     ,
+	//       -  .
+	//   T -  ,   TDynamicMatrix (tlu.h): 
+	// ,  ,   ,    
+	TDynamicVector<T, A> Solve(const TDynamicVector<T, A>& b) const;
+	TDynamicMatrix<T, A> Solve(const TDynamicMatrix<T, A>& b) const;
+
+	friend istream& operator>>(istream& istr, TBandMatrix& m)
+	{
+		for (size_t i = 0; i < m.sz; i++)
+			for (size_t j = i > m.nLower ? i - m.nLower : 0; j < m.sz && j <= i + m.nUpper; j++)
+				istr >> m(i, j);
+		return istr;
+	}
+	friend ostream& operator<<(ostream& ostr, const TBandMatrix& m)
+	{
+		for (size_t i = 0; i < m.sz; i++)
+		{
+			for (size_t j = 0; j < m.sz; j++)
+				ostr << m(i, j) << '\t';
+			ostr << endl;
+		}
+		return ostr;
+	}
+};
+
+template<typename T, typename A>
+struct TIsExprContainer<TBandMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+struct TExprShape<TBandMatrix<T, A>>
+{
+	static size_t Of(const TBandMatrix<T, A>& m) noexcept { return m.kl(); }
+};
+
+template<typename T, typename A>
+inline size_t TBandMatrix<T, A>::CheckSize(size_t s, size_t kl, size_t ku)
+{
+	if (s == 0)
+		throw out_of_range("Size should be greater than zero");
+	if (kl >= s || ku >= s)
+		throw "Bandwidth should be less than matrix size";
+	if (kl + ku + 1 > MAX_VECTOR_SIZE / s)
+		throw out_of_range("Matrix size should be less than MAX_VECTOR_SIZE");
+	return (kl + ku + 1) * s;
+}
+
+template<typename T, typename A>
+inline TBandMatrix<T, A>::TBandMatrix(size_t s, size_t kl, size_t ku, const T& val, const A& alloc) : TDynamicVector<T, A>(CheckSize(s, kl, ku), val, alloc), sz(s), nLower(kl), nUpper(ku)
+{
+	ClearPadding();
+}
+
+template<typename T, typename A>
+inline void TBandMatrix<T, A>::ClearPadding()
+{
+	for (size_t d = 1; d <= nLower; d++)
+		std::fill(pMem + DiagOffset(-ptrdiff_t(d)), pMem + DiagOffset(-ptrdiff_t(d)) + d, T());
+	for (size_t d = 1; d <= nUpper; d++)
+		std::fill(pMem + DiagOffset(ptrdiff_t(d)) + sz - d, pMem + DiagOffset(ptrdiff_t(d)) + sz, T());
+}
+
+template<typename T, typename A>
+template<typename E, typename>
+inline TBandMatrix<T, A>& TBandMatrix<T, A>::operator=(const TExpr<E>& e)
+{
+	this->AssignExpr(e.self(), "bandmatrix.expr_assign");
+	sz = e.self().dim();
+	nLower = e.self().shape();
+	nUpper = e.self().count() / sz - 1 - nLower;
+	return *this;
+}
+
+template<typename T, typename A>
+inline T& TBandMatrix<T, A>::operator()(size_t i, size_t j)
+{
+	if (!InBand(i, j)) throw "Element is outside of the band";
+	return pMem[DiagOffset(ptrdiff_t(j) - ptrdiff_t(i)) + i];
+}
+
+template<typename T, typename A>
+inline T& TBandMatrix<T, A>::at(size_t i, size_t j)
+{
+	if (i >= sz || j >= sz) throw out_of_range("index is out of range");
+	return this->operator()(i, j);
+}
+
+template<typename T, typename A>
+inline const T& TBandMatrix<T, A>::operator()(size_t i, size_t j) const
+{
+	static const T zero = T();
+	if (!InBand(i, j))
+		return zero;
+	return pMem[DiagOffset(ptrdiff_t(j) - ptrdiff_t(i)) + i];
+}
+
+template<typename T, typename A>
+inline const T& TBandMatrix<T, A>::at(size_t i, size_t j) const
+{
+	if (i >= sz || j >= sz) throw out_of_range("index is out of range");
+	return this->operator()(i, j);
+}
+
+template<typename T, typename A>
+inline TBandMatrix<T, A>::operator TDynamicMatrix<T, A>() const
+{
+	TDynamicMatrix<T, A> tmp(sz, T(), get_allocator());
+	for (size_t i = 0; i < sz; i++)
+		for (size_t j = i > nLower ? i - nLower : 0; j < sz && j <= i + nUpper; j++)
+			tmp[i][j] = this->operator()(i, j);
+	return tmp;
+}
+
+template<typename T, typename A>
+inline bool TBandMatrix<T, A>::operator==(const TBandMatrix& m) const noexcept
+{
+	if (sz != m.sz || nLower != m.nLower || nUpper != m.nUpper)
+		return false;
+	return this->TDynamicVector<T, A>::operator==(m);
+}
+
+template<typename T, typename A>
+inline bool TBandMatrix<T, A>::operator!=(const TBandMatrix& m) const noexcept
+{
+	return !(this->operator==(m));
+}
+
+template<typename T, typename A>
+inline TBandMatrix<T, A>& TBandMatrix<T, A>::operator*=(const T& val)
+{
+	return *this = *this * val;
+}
+
+template<typename T, typename A>
+inline TBandMatrix<T, A>& TBandMatrix<T, A>::operator/=(const T& val)
+{
+	return *this = *this / val;
+}
+
+template<typename T, typename A>
+template<typename X, typename>
+inline TBandMatrix<T, A>& TBandMatrix<T, A>::operator+=(const X& m)
+{
+	return *this = *this + m;
+}
+
+template<typename T, typename A>
+template<typename X, typename>
+inline TBandMatrix<T, A>& TBandMatrix<T, A>::operator-=(const X& m)
+{
+	return *this = *this - m;
+}
+
+//   : y[i] += D[i] * x[i + d],  
+// ;     
+template<typename T, typename A>
+inline TDynamicVector<T, A> TBandMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
+{
+	if (sz != v.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> tmp(sz, T(), get_allocator());
+	const T* x = &v[0];
+	T* y = &tmp[0];
+	ParallelChunks(sz, nLower + nUpper + 1, [&](size_t begin, size_t end)
+	{
+		for (ptrdiff_t d = -ptrdiff_t(nLower); d <= ptrdiff_t(nUpper); d++)
+		{
+			const T* D = pMem + DiagOffset(d);
+			const size_t i0 = d < 0 && begin < size_t(-d) ? size_t(-d) : begin;
+			const size_t i1 = d > 0 && end > sz - size_t(d) ? sz - size_t(d) : end;
+			for (size_t i = i0; i < i1; i++)
+				y[i] = y[i] + D[i] * x[i + d];
+		}
+	});
+	return tmp;
+}
+
+//   ( , O(n)   ).
+//     ,   
+//  .     :
+//       (   ),
+//   .     false
+template<typename T, typename A>
+inline bool TBandMatrix<T, A>::SolveThomas(const T* b, T* x, size_t m) const
+{
+	const T* a = pMem;
+	const T* c = pMem + 2 * sz;
+	const T* dg = pMem + sz;
+	for (size_t i = 0; i < sz; i++)
+	{
+		const T ai = a[i], ci = c[i], di = dg[i];
+		if (std::abs(di) < std::abs(ai) + std::abs(ci) || di == T())
+			return false;
+	}
+	TDynamicVector<T> cp(sz), dp(sz * m);
+	cp[0] = c[0] / dg[0];
+	for (size_t k = 0; k < m; k++)
+		dp[k] = b[k] / dg[0];
+	for (size_t i = 1; i < sz; i++)
+	{
+		const T ai = a[i];
+		const T den = dg[i] - ai * cp[i - 1];
+		//     NaN
+		if (!(std::abs(den) > std::numeric_limits<T>::epsilon() * (std::abs(dg[i]) + std::abs(ai * cp[i - 1]))))
+			return false;
+		cp[i] = c[i] / den;
+		for (size_t k = 0; k < m; k++)
+			dp[i * m + k] = (b[i * m + k] - ai * dp[(i - 1) * m + k]) / den;
+	}
+	for (size_t i = sz - 1; i-- > 0;)
+		for (size_t k = 0; k < m; k++)
+			dp[i * m + k] = dp[i * m + k] - cp[i] * dp[(i + 1) * m + k];
+	for (size_t i = 0; i < sz * m; i++)
+		x[i] = dp[i];
+	return true;
+}
+
+// LU-        ( dgbtrf).
+//       kl + ku,  
+//      2 * kl + ku + 1:  (i, j) 
+//   i   j - i + kl.  L    ,
+//         .
+//   T -   ( LUFactor, tlu.h)   :
+//         
+// ,  ,      k,  
+//    k - 1     .  
+// U(i, k)    , U(n - 1, n - 1) = det(PA)
+template<typename T, typename A>
+inline int TBandMatrix<T, A>::FactorBand(TDynamicVector<T>& lu, TDynamicVector<size_t>& perm) const
+{
+	const size_t kl = nLower, w = 2 * nLower + nUpper + 1, ub = nLower + nUpper;
+	lu = TDynamicVector<T>(w * sz, T());
+	perm = TDynamicVector<size_t>(sz);
+	auto U = [&](size_t i, size_t j) -> T& { return lu[i * w + j + kl - i]; };
+	for (size_t i = 0; i < sz; i++)
+		for (size_t j = i > nLower ? i - nLower : 0; j < sz && j <= i + nUpper; j++)
+			U(i, j) = this->operator()(i, j);
+	int sign = 1;
+	T prev = 1;
+	for (size_t k = 0; k < sz; k++)
+	{
+		const size_t last = k + kl < sz ? k + kl : sz - 1;
+		const size_t right = k + ub < sz ? k + ub : sz - 1;
+		size_t p = k;
+		if constexpr (std::is_integral<T>::value)
+		{
+			if (k + kl < sz)
+				for (size_t j = k; j <= k + kl + nUpper && j < sz; j++)
+					U(k + kl, j) = U(k + kl, j) * prev;
+			while (p <= last && U(p, k) == T())
+				p++;
+			if (p > last)
+				return 0;
+		}
+		else
+		{
+			T pmax = std::abs(U(k, k));
+			for (size_t i = k + 1; i <= last; i++)
+				if (pmax < std::abs(U(i, k)))
+				{
+					pmax = std::abs(U(i, k));
+					p = i;
+				}
+			if (pmax == T())
+				return 0;
+		}
+		perm[k] = p;
+		if (p != k)
+		{
+			for (size_t j = k; j <= right; j++)
+				std::swap(U(k, j), U(p, j));
+			sign = -sign;
+		}
+		for (size_t i = k + 1; i <= last; i++)
+		{
+			if constexpr (std::is_integral<T>::value)
+			{
+				for (size_t j = k + 1; j <= right; j++)
+					U(i, j) = (U(i, j) * U(k, k) - U(i, k) * U(k, j)) / prev;
+			}
+			else
+			{
+				const T f = U(i, k) / U(k, k);
+				U(i, k) = f;
+				for (size_t j = k + 1; j <= right; j++)
+					U(i, j) = U(i, j) - f * U(k, j);
+			}
+		}
+		prev = U(k, k);
+	}
+	return sign;
+}
+
+template<typename T, typename A>
+inline void TBandMatrix<T, A>::SolveBand(const T* b, T* x, size_t m) const
+{
+	TDynamicVector<T> lu;
+	TDynamicVector<size_t> perm;
+	if (FactorBand(lu, perm) == 0)
+		throw "Can't solve system with singular matrix.";
+	const size_t kl = nLower, w = 2 * nLower + nUpper + 1, ub = nLower + nUpper;
+	auto U = [&](size_t i, size_t j) { return lu[i * w + j + kl - i]; };
+	for (size_t i = 0; i < sz * m; i++)
+		x[i] = b[i];
+
+	//  :    L (  T -  
+	//    )   
+	T prev = 1;
+	for (size_t k = 0; k < sz; k++)
+	{
+		const size_t last = k + kl < sz ? k + kl : sz - 1;
+		if constexpr (std::is_integral<T>::value)
+			if (k + kl < sz)
+				for (size_t c = 0; c < m; c++)
+					x[(k + kl) * m + c] = x[(k + kl) * m + c] * prev;
+		if (perm[k] != k)
+			for (size_t c = 0; c < m; c++)
+				std::swap(x[k * m + c], x[perm[k] * m + c]);
+		for (size_t i = k + 1; i <= last; i++)
+		{
+			const T f = U(i, k);
+			for (size_t c = 0; c < m; c++)
+			{
+				if constexpr (std::is_integral<T>::value)
+					x[i * m + c] = (x[i * m + c] * U(k, k) - f * x[k * m + c]) / prev;
+				else
+					x[i * m + c] = x[i * m + c] - f * x[k * m + c];
+			}
+		}
+		prev = U(k, k);
+	}
+	//  : U x = y,   U   kl + ku ;
+	//   T   det * x,    det
+	const T d = U(sz - 1, sz - 1);
+	for (size_t i = sz; i-- > 0;)
+	{
+		const size_t right = i + ub < sz ? i + ub : sz - 1;
+		if constexpr (std::is_integral<T>::value)
+			for (size_t c = 0; c < m; c++)
+				x[i * m + c] = x[i * m + c] * d;
+		for (size_t j = i + 1; j <= right; j++)
+		{
+			const T f = U(i, j);
+			for (size_t c = 0; c < m; c++)
+				x[i * m + c] = x[i * m + c] - f * x[j * m + c];
+		}
+		for (size_t c = 0; c < m; c++)
+			x[i * m + c] = x[i * m + c] / U(i, i);
+	}
+	if constexpr (std::is_integral<T>::value)
+		for (size_t i = 0; i < sz * m; i++)
+			x[i] = x[i] / d;
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TBandMatrix<T, A>::Solve(const TDynamicVector<T, A>& b) const
+{
+	if (sz != b.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> x(sz, T(), get_allocator());
+	bool done = false;
+	if constexpr (!std::is_integral<T>::value)
+		done = nLower == 1 && nUpper == 1 && SolveThomas(&b[0], &x[0], 1);
+	if (!done)
+		SolveBand(&b[0], &x[0], 1);
+	return x;
+}
+
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TBandMatrix<T, A>::Solve(const TDynamicMatrix<T, A>& b) const
+{
+	if (sz != b.size()) throw "Sizes are not equal";
+	TDynamicMatrix<T, A> x(sz, T(), get_allocator());
+	bool done = false;
+	if constexpr (!std::is_integral<T>::value)
+		done = nLower == 1 && nUpper == 1 && SolveThomas(&b[0][0], &x[0][0], sz);
+	if (!done)
+		SolveBand(&b[0][0], &x[0][0], sz);
+	return x;
+}
+
+//  -   U   LU-
+// (  T -     )
+template<typename T, typename A>
+inline T TBandMatrix<T, A>::Det() const
+{
+	TDynamicVector<T> lu;
+	TDynamicVector<size_t> perm;
+	const int sign = FactorBand(lu, perm);
+	if (sign == 0)
+		return T();
+	const size_t w = 2 * nLower + nUpper + 1;
+	T det;
+	if constexpr (std::is_integral<T>::value)
+		det = lu[(sz - 1) * w + nLower];
+	else
+	{
+		det = 1;
+		for (size_t k = 0; k < sz; k++)
+			det = det * lu[k * w + nLower];
+	}
+	return sign > 0 ? det : -det;
+}
+
+#endif
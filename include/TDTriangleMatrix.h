@@ -12,19 +12,37 @@
 
 using namespace std;
 
-template<typename T>
-class TDTriangleMatrix : private TDynamicVector<TDynamicVector<T>>
+//  :   
+//    ,  i ( i + 1)   RowOffset(i)
+template<typename T, typename A = TAlignedAllocator<T>>
+class TDTriangleMatrix : private TDynamicVector<T, A>
 {
 protected:
-	using TDynamicVector<TDynamicVector<T>>::pMem;
-	using TDynamicVector<TDynamicVector<T>>::sz;
+	using TDynamicVector<T, A>::pMem;
+	size_t sz;
 
+	TDTriangleMatrix(size_t s, TDynamicVector<T, A>&& data) noexcept : TDynamicVector<T, A>(std::move(data)), sz(s) {}
+	static size_t CheckSize(size_t s);
+	static size_t RowOffset(size_t i) noexcept { return i * (i + 1) / 2; }
+
+	friend struct TExprAccess;
 public:
-	TDTriangleMatrix(size_t s = 2, const T& val = T());
+	typedef T value_type;
+	typedef A allocator_type;
+
+	TDTriangleMatrix(size_t s = 2, const T& val = T(), const A& alloc = A());
+	//    (texpr.h)   
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDTriangleMatrix>::value>::type>
+	TDTriangleMatrix(const TExpr<E>& e) : TDynamicVector<T, A>(e, TExprFlat(), "dtmatrix.expr_construct"), sz(e.self().dim()) {}
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDTriangleMatrix>::value>::type>
+	TDTriangleMatrix& operator=(const TExpr<E>& e);
 
-	using TDynamicVector<TDynamicVector<T>>::size;
-	using TDynamicVector<TDynamicVector<T>>::operator[];
-	using TDynamicVector<TDynamicVector<T>>::at;
+	size_t size() const noexcept { return sz; }
+	using TDynamicVector<T, A>::get_allocator;
+	TRowView<T, A> operator[](size_t ind) { return TRowView<T, A>(pMem + RowOffset(ind), ind + 1); }
+	TRowView<const T, A> operator[](size_t ind) const { return TRowView<const T, A>(pMem + RowOffset(ind), ind + 1); }
+	TRowView<T, A> at(size_t ind);
+	TRowView<const T, A> at(size_t ind) const;
 	T& operator()(size_t i, size_t j);
 	T& at(size_t i, size_t j);
 	const T& operator()(size_t i, size_t j) const;
@@ -34,23 +52,31 @@ public:
 	bool operator==(const TDTriangleMatrix& m) const noexcept;
 	bool operator!=(const TDTriangleMatrix& m) const noexcept;
 
-	//  
-	TDTriangleMatrix operator*(const T& val);
-	TDTriangleMatrix operator/(const T& val);
-	TDTriangleMatrix operator-(void);
+	//  ,    -   (texpr.h)
+
+	//    
+	TDTriangleMatrix& operator*=(const T& val);
+	TDTriangleMatrix& operator/=(const T& val);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TDTriangleMatrix, X>::value>::type>
+	TDTriangleMatrix& operator+=(const X& m);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TDTriangleMatrix, X>::value>::type>
+	TDTriangleMatrix& operator-=(const X& m);
+	TDTriangleMatrix& operator*=(const TDTriangleMatrix& m);
 
 	// - 
-	TDynamicVector<T> operator*(const TDynamicVector<T>& v);
+	TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
 
 	//  
-	TDTriangleMatrix operator+(const TDTriangleMatrix& m);
-	TDTriangleMatrix operator-(const TDTriangleMatrix& m);
-	TDTriangleMatrix operator*(const TDTriangleMatrix& m);
+	TDTriangleMatrix operator*(const TDTriangleMatrix& m) const;
+
+	//   (/ ); unitDiag -   
+	TDynamicVector<T, A> Solve(const TDynamicVector<T, A>& b, bool unitDiag = false) const;
+	TDynamicMatrix<T, A> Solve(const TDynamicMatrix<T, A>& b, bool unitDiag = false) const;
 
 	friend istream& operator>>(istream& istr, TDTriangleMatrix& m)
 	{
 		for (size_t i = 0; i < m.sz; i++)
-			istr >> m.pMem[i];
+			istr >> m[i];
 		return istr;
 	}
 	friend ostream& operator<<(ostream& ostr, const TDTriangleMatrix& m)
@@ -58,8 +84,8 @@ public:
 		for (size_t i = 0; i < m.sz; i++)
 		{
 			// ostr << m.pMem[i];
-			ostr << m.pMem[i];
-			for (size_t j = m.pMem[i].size(); j < m.sz; j++)
+			ostr << m[i];
+			for (size_t j = i + 1; j < m.sz; j++)
 				// ostr << '0' << ' ';
 				ostr << '0' << '\t';
 			ostr << endl;
@@ -68,130 +94,239 @@ public:
 	}
 };
 
-template<typename T>
-inline TDTriangleMatrix<T>::TDTriangleMatrix(size_t s, const T& val) : TDynamicVector<TDynamicVector<T>>(s)
+template<typename T, typename A>
+struct TIsExprContainer<TDTriangleMatrix<T, A>> : std::true_type {};
+
+//  i  (i + 1 )
+template<typename T, typename A>
+struct TExprIndex<TDTriangleMatrix<T, A>>
+{
+	template<typename X>
+	static TExprSlice<X> Get(const X& e, size_t i) { return TExprSlice<X>(e, i * (i + 1) / 2, i + 1); }
+};
+
+template<typename T, typename A>
+inline size_t TDTriangleMatrix<T, A>::CheckSize(size_t s)
 {
-	if (sz > MAX_MATRIX_SIZE)
+	if (s > MAX_MATRIX_SIZE)
 		throw out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
-	if (sz == 1)
+	if (s == 1)
 		throw "Triangle Matrix with size 1 doesn't make sense.";
-	for (size_t i = 0; i < sz; i++)
-		pMem[i] = TDynamicVector<T>(i + 1, val);
+	return s;
+}
+
+template<typename T, typename A>
+inline TDTriangleMatrix<T, A>::TDTriangleMatrix(size_t s, const T& val, const A& alloc) : TDynamicVector<T, A>(RowOffset(CheckSize(s)), val, alloc), sz(s)
+{
+}
+
+template<typename T, typename A>
+inline TRowView<T, A> TDTriangleMatrix<T, A>::at(size_t ind)
+{
+	if (pMem == nullptr) throw "pMem is nullptr";
+	if (ind >= sz) throw out_of_range("index is out of range");
+	return this->operator[](ind);
 }
 
-template<typename T>
-inline T& TDTriangleMatrix<T>::operator()(size_t i, size_t j)
+template<typename T, typename A>
+inline TRowView<const T, A> TDTriangleMatrix<T, A>::at(size_t ind) const
 {
-	return (this->operator[](i))[j];
+	if (pMem == nullptr) throw "pMem is nullptr";
+	if (ind >= sz) throw out_of_range("index is out of range");
+	return this->operator[](ind);
 }
 
-template<typename T>
-inline T& TDTriangleMatrix<T>::at(size_t i, size_t j)
+template<typename T, typename A>
+inline T& TDTriangleMatrix<T, A>::operator()(size_t i, size_t j)
+{
+	return pMem[RowOffset(i) + j];
+}
+
+template<typename T, typename A>
+inline T& TDTriangleMatrix<T, A>::at(size_t i, size_t j)
 {
 	return this->at(i).at(j);
 }
 
-template<typename T>
-inline const T& TDTriangleMatrix<T>::operator()(size_t i, size_t j) const
+template<typename T, typename A>
+inline const T& TDTriangleMatrix<T, A>::operator()(size_t i, size_t j) const
 {
-	return (this->operator[](i))[j];
+	return pMem[RowOffset(i) + j];
 }
 
-template<typename T>
-inline const T& TDTriangleMatrix<T>::at(size_t i, size_t j) const
+template<typename T, typename A>
+inline const T& TDTriangleMatrix<T, A>::at(size_t i, size_t j) const
 {
 	return this->at(i).at(j);
 }
 
-template<typename T>
-inline bool TDTriangleMatrix<T>::operator==(const TDTriangleMatrix<T>& m) const noexcept
+template<typename T, typename A>
+template<typename E, typename>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator=(const TExpr<E>& e)
+{
+	this->AssignExpr(e.self(), "dtmatrix.expr_assign");
+	sz = e.self().dim();
+	return *this;
+}
+
+template<typename T, typename A>
+inline bool TDTriangleMatrix<T, A>::operator==(const TDTriangleMatrix<T, A>& m) const noexcept
 {
-	return this->TDynamicVector<TDynamicVector<T>>::operator==(m);
+	if (sz != m.sz)
+		return false;
+	return this->TDynamicVector<T, A>::operator==(m);
 }
 
-template<typename T>
-inline bool TDTriangleMatrix<T>::operator!=(const TDTriangleMatrix<T>& m) const noexcept
+template<typename T, typename A>
+inline bool TDTriangleMatrix<T, A>::operator!=(const TDTriangleMatrix<T, A>& m) const noexcept
 {
 	return !(this->operator==(m));
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator*(const T& val)
+template<typename T, typename A>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator*=(const T& val)
 {
-	TDTriangleMatrix tmp(*this);
-	for (size_t i = 0; i < sz; i++)
-	{
-		tmp[i] = tmp[i] * val;
-	}
-	return tmp;
+	return *this = *this * val;
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator/(const T& val)
+template<typename T, typename A>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator/=(const T& val)
 {
-	TDTriangleMatrix tmp(*this);
-	for (size_t i = 0; i < sz; i++)
-	{
-		tmp[i] = tmp[i] / val;
-	}
-	return tmp;
+	return *this = *this / val;
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator-(void)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator+=(const X& m)
 {
-	TDTriangleMatrix<T> tmp(sz);
-	for (size_t i = 0; i < sz; i++)
-		tmp[i] = -(this->operator[](i));
-	return tmp;
+	return *this = *this + m;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDTriangleMatrix<T>::operator*(const TDynamicVector<T>& v)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator-=(const X& m)
 {
-	if (sz != v.size()) throw "Sizes are not equal";
-	TDynamicVector<T> tmp(sz);
-	for (size_t i = 0; i < sz; i++)
+	return *this = *this - m;
+}
+
+//  i      i  *this
+//   k <= i  m:      
+//    ,  m    *this
+template<typename T, typename A>
+inline TDTriangleMatrix<T, A>& TDTriangleMatrix<T, A>::operator*=(const TDTriangleMatrix<T, A>& m)
+{
+	TAllocSite site("dtmatrix.mul_assign");
+	if (sz != m.size()) throw "Sizes are not equal";
+	T* ci = TGemmWorkspace<T>::Local().Result(sz);
+	for (size_t i = sz; i-- > 0;)
 	{
-		for (size_t j = 0; j <= i; j++)
+		T* ai = pMem + RowOffset(i);
+		std::fill(ci, ci + i + 1, T());
+		for (size_t k = 0; k <= i; k++)
 		{
-			tmp[i] = tmp[i] + this->operator()(i, j) * v[j];
+			const T aik = ai[k];
+			const T* bk = m.pMem + RowOffset(k);
+			for (size_t j = 0; j <= k; j++)
+				ci[j] = ci[j] + aik * bk[j];
 		}
+		std::copy(ci, ci + i + 1, ai);
 	}
-	return tmp;
+	return *this;
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator+(const TDTriangleMatrix<T>& m)
+template<typename T, typename A>
+inline TDynamicVector<T, A> TDTriangleMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
 {
-	if (sz != m.size()) throw "Sizes are not equal";
-	TDTriangleMatrix tmp(sz);
+	TAllocSite site("dtmatrix.mul_vector");
+	if (sz != v.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> tmp(sz, TUninitialized(), get_allocator());
 	for (size_t i = 0; i < sz; i++)
-		tmp[i] = this->operator[](i) + m[i];
+	{
+		const T* row = pMem + RowOffset(i);
+		T s = T();
+		for (size_t j = 0; j <= i; j++)
+			s = s + row[j] * v[j];
+		tmp[i] = s;
+	}
 	return tmp;
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator-(const TDTriangleMatrix<T>& m)
+template<typename T, typename A>
+inline TDTriangleMatrix<T, A> TDTriangleMatrix<T, A>::operator*(const TDTriangleMatrix<T, A>& m) const
 {
+	TAllocSite site("dtmatrix.mul_matrix");
 	if (sz != m.size()) throw "Sizes are not equal";
-	TDTriangleMatrix tmp(sz);
+	TDTriangleMatrix tmp(sz, T(), get_allocator());
 	for (size_t i = 0; i < sz; i++)
-		tmp[i] = this->operator[](i) - m[i];
+	{
+		const T* ai = pMem + RowOffset(i);
+		T* ci = tmp.pMem + RowOffset(i);
+		for (size_t k = 0; k <= i; k++)
+		{
+			const T aik = ai[k];
+			const T* bk = m.pMem + RowOffset(k);
+			for (size_t j = 0; j <= k; j++)
+				ci[j] = ci[j] + aik * bk[j];
+		}
+	}
 	return tmp;
 }
 
-template<typename T>
-inline TDTriangleMatrix<T> TDTriangleMatrix<T>::operator*(const TDTriangleMatrix<T>& m)
+template<typename T, typename A>
+inline TDynamicVector<T, A> TDTriangleMatrix<T, A>::Solve(const TDynamicVector<T, A>& b, bool unitDiag) const
 {
-	if (sz != m.size()) throw "Sizes are not equal";
-	TDTriangleMatrix tmp(sz);
+	TAllocSite site("dtmatrix.solve_vector");
+	if (sz != b.size()) throw "Sizes are not equal";
+	if (!unitDiag)
+		for (size_t i = 0; i < sz; i++)
+			if (pMem[RowOffset(i) + i] == T())
+				throw "Can't solve system with singular matrix.";
+	TDynamicVector<T, A> x(b);
 	for (size_t i = 0; i < sz; i++)
-		for (size_t j = 0; j <= i; j++)
-			for (size_t k = 0; k <= i; k++)
-				if (k >= j)
-					tmp(i, j) = tmp(i, j) + this->operator()(i, k) * m(k, j);
-	return tmp;
+	{
+		const T* row = pMem + RowOffset(i);
+		T s = x[i];
+		for (size_t j = 0; j < i; j++)
+			s = s - row[j] * x[j];
+		x[i] = unitDiag ? s : s / row[i];
+	}
+	return x;
+}
+
+//      TRSM_BLOCK ,
+//        
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TDTriangleMatrix<T, A>::Solve(const TDynamicMatrix<T, A>& b, bool unitDiag) const
+{
+	TAllocSite site("dtmatrix.solve_matrix");
+	if (sz != b.size()) throw "Sizes are not equal";
+	if (!unitDiag)
+		for (size_t i = 0; i < sz; i++)
+			if (pMem[RowOffset(i) + i] == T())
+				throw "Can't solve system with singular matrix.";
+	const size_t TRSM_BLOCK = 256;
+	TDynamicMatrix<T, A> x(b);
+	T* px = &x[0][0];
+	for (size_t c0 = 0; c0 < sz; c0 += TRSM_BLOCK)
+	{
+		const size_t c1 = c0 + TRSM_BLOCK < sz ? c0 + TRSM_BLOCK : sz;
+		for (size_t i = 0; i < sz; i++)
+		{
+			const T* row = pMem + RowOffset(i);
+			T* xi = px + i * sz;
+			for (size_t j = 0; j < i; j++)
+			{
+				const T f = row[j];
+				const T* xj = px + j * sz;
+				for (size_t c = c0; c < c1; c++)
+					xi[c] = xi[c] - f * xj[c];
+			}
+			if (!unitDiag)
+				for (size_t c = c0; c < c1; c++)
+					xi[c] = xi[c] / row[i];
+		}
+	}
+	return x;
 }
 
 #endif
\ No newline at end of file
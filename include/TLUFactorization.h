@@ -0,0 +1,94 @@
+// , ,  "   "
+//
+//
+//
+//
+
+#ifndef __TLUFactorization_H__
+#define __TLUFactorization_H__
+
+#include "tmatrix.h"
+#include "tlu.h"
+#include <iostream>
+
+using namespace std;
+
+// LU- PA = LU,    (O(n^3)):
+// L  U      n x n, P -   .
+//      O(n^2)   
+template<typename T, typename A = TAlignedAllocator<T>>
+class TLUFactorization
+{
+protected:
+	size_t sz;
+	TDynamicVector<T, A> lu;
+	TDynamicVector<size_t, typename std::allocator_traits<A>::template rebind_alloc<size_t>> perm;
+	int sign;
+
+	void CheckSingular() const;
+public:
+	TLUFactorization(const TDynamicMatrix<T, A>& m);
+
+	size_t size() const noexcept { return sz; }
+	bool IsSingular() const noexcept { return sign == 0; }
+	//   ,   
+	A get_allocator() const noexcept { return lu.get_allocator(); }
+
+	T Det() const;
+	TDynamicVector<T, A> Solve(const TDynamicVector<T, A>& b) const;
+	TDynamicMatrix<T, A> Solve(const TDynamicMatrix<T, A>& b) const;
+	TDynamicMatrix<T, A> Inverse() const;
+};
+
+template<typename T, typename A = TAlignedAllocator<T>>
+using LUFactorization = TLUFactorization<T, A>;
+
+template<typename T, typename A>
+inline TLUFactorization<T, A>::TLUFactorization(const TDynamicMatrix<T, A>& m) : sz(m.size()), lu(&m[0][0], m.size() * m.size(), m.get_allocator()), perm(m.size(), 0, m.get_allocator())
+{
+	sign = LUFactor(&lu[0], sz, &perm[0]);
+}
+
+template<typename T, typename A>
+inline void TLUFactorization<T, A>::CheckSingular() const
+{
+	if (IsSingular())
+		throw "Can't solve system with singular matrix.";
+}
+
+template<typename T, typename A>
+inline T TLUFactorization<T, A>::Det() const
+{
+	return LUDet(&lu[0], sz, sign);
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TLUFactorization<T, A>::Solve(const TDynamicVector<T, A>& b) const
+{
+	if (sz != b.size()) throw "Sizes are not equal";
+	CheckSingular();
+	TDynamicVector<T, A> x(sz, TUninitialized(), get_allocator());
+	LUSolve(&lu[0], sz, &perm[0], &b[0], &x[0], 1);
+	return x;
+}
+
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TLUFactorization<T, A>::Solve(const TDynamicMatrix<T, A>& b) const
+{
+	if (sz != b.size()) throw "Sizes are not equal";
+	CheckSingular();
+	TDynamicMatrix<T, A> x(sz, TUninitialized(), get_allocator());
+	LUSolve(&lu[0], sz, &perm[0], &b[0][0], &x[0][0], sz);
+	return x;
+}
+
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TLUFactorization<T, A>::Inverse() const
+{
+	TDynamicMatrix<T, A> e(sz, T(), get_allocator());
+	for (size_t i = 0; i < sz; i++)
+		e[i][i] = 1;
+	return this->Solve(e);
+}
+
+#endif
@@ -0,0 +1,288 @@
+// , ,  "   "
+//
+//
+//
+//
+
+#ifndef __TRectMatrix_H__
+#define __TRectMatrix_H__
+
+#include "tmatrix.h"
+#include <iostream>
+
+using namespace std;
+
+//   rows x cols:   
+//    ,   TDynamicMatrix
+template<typename T, typename A = TAlignedAllocator<T>>
+class TRectMatrix : private TDynamicVector<T, A>
+{
+protected:
+	using TDynamicVector<T, A>::pMem;
+	size_t nRows, nCols;
+
+	static size_t CheckSize(size_t rows, size_t cols);
+
+	friend struct TExprAccess;
+public:
+	typedef T value_type;
+	typedef A allocator_type;
+
+	TRectMatrix(size_t rows = 1, size_t cols = 1, const T& val = T(), const A& alloc = A());
+	//      (. TDynamicVector)
+	TRectMatrix(size_t rows, size_t cols, TUninitialized, const A& alloc = A());
+	explicit TRectMatrix(const TDynamicMatrix<T, A>& m);
+	//    (texpr.h)   
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TRectMatrix>::value>::type>
+	TRectMatrix(const TExpr<E>& e) : TDynamicVector<T, A>(e, TExprFlat(), "rectmatrix.expr_construct"), nRows(e.self().dim()), nCols(e.self().count() / e.self().dim()) {}
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TRectMatrix>::value>::type>
+	TRectMatrix& operator=(const TExpr<E>& e);
+
+	size_t rows() const noexcept { return nRows; }
+	size_t cols() const noexcept { return nCols; }
+	//   :   
+	size_t size() const noexcept { return nRows; }
+	using TDynamicVector<T, A>::get_allocator;
+
+	// 
+	TRowView<T, A> operator[](size_t ind) { return TRowView<T, A>(pMem + ind * nCols, nCols); }
+	TRowView<const T, A> operator[](size_t ind) const { return TRowView<const T, A>(pMem + ind * nCols, nCols); }
+	//   
+	TRowView<T, A> at(size_t ind);
+	TRowView<const T, A> at(size_t ind) const;
+	TDynamicVector<T, A> Column(size_t j) const;
+
+	//   (  rows == cols)
+	explicit operator TDynamicMatrix<T, A>() const;
+
+	//     dst  cols x rows
+	void Transposed(TRectMatrix& dst) const;
+
+	// 
+	bool operator==(const TRectMatrix& m) const noexcept;
+	bool operator!=(const TRectMatrix& m) const noexcept;
+
+	//  ,    -   (texpr.h)
+
+	//    
+	TRectMatrix& operator*=(const T& val);
+	TRectMatrix& operator/=(const T& val);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TRectMatrix, X>::value>::type>
+	TRectMatrix& operator+=(const X& m);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TRectMatrix, X>::value>::type>
+	TRectMatrix& operator-=(const X& m);
+
+	// -  (rows x cols    cols)
+	TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
+
+	//   (rows x cols  cols x k)
+	TRectMatrix operator*(const TRectMatrix& m) const;
+	TRectMatrix operator*(const TDynamicMatrix<T, A>& m) const;
+
+	friend istream& operator>>(istream& istr, TRectMatrix& m)
+	{
+		for (size_t i = 0; i < m.nRows; i++)
+			istr >> m[i];
+		return istr;
+	}
+	friend ostream& operator<<(ostream& ostr, const TRectMatrix& m)
+	{
+		for (size_t i = 0; i < m.nRows; i++)
+			ostr << m[i] << endl;
+		return ostr;
+	}
+};
+
+template<typename T, typename A>
+struct TIsExprContainer<TRectMatrix<T, A>> : std::true_type {};
+
+//  i 
+template<typename T, typename A>
+struct TExprIndex<TRectMatrix<T, A>>
+{
+	template<typename X>
+	static TExprSlice<X> Get(const X& e, size_t i) { return TExprSlice<X>(e, i * (e.count() / e.dim()), e.count() / e.dim()); }
+};
+
+//    (n x n  n x k)
+template<typename T, typename A>
+TRectMatrix<T, A> operator*(const TDynamicMatrix<T, A>& a, const TRectMatrix<T, A>& b);
+
+template<typename T, typename A>
+inline size_t TRectMatrix<T, A>::CheckSize(size_t rows, size_t cols)
+{
+	if (rows == 0 || cols == 0)
+		throw out_of_range("Size should be greater than zero");
+	if (cols > MAX_VECTOR_SIZE / rows)
+		throw out_of_range("Matrix size should be less than MAX_VECTOR_SIZE");
+	return rows * cols;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>::TRectMatrix(size_t rows, size_t cols, const T& val, const A& alloc) : TDynamicVector<T, A>(CheckSize(rows, cols), val, alloc), nRows(rows), nCols(cols)
+{
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>::TRectMatrix(size_t rows, size_t cols, TUninitialized, const A& alloc) : TDynamicVector<T, A>(CheckSize(rows, cols), TUninitialized(), alloc), nRows(rows), nCols(cols)
+{
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>::TRectMatrix(const TDynamicMatrix<T, A>& m) : TDynamicVector<T, A>(&m[0][0], m.size() * m.size(), m.get_allocator()), nRows(m.size()), nCols(m.size())
+{
+}
+
+template<typename T, typename A>
+template<typename E, typename>
+inline TRectMatrix<T, A>& TRectMatrix<T, A>::operator=(const TExpr<E>& e)
+{
+	this->AssignExpr(e.self(), "rectmatrix.expr_assign");
+	nRows = e.self().dim();
+	nCols = e.self().count() / nRows;
+	return *this;
+}
+
+template<typename T, typename A>
+inline TRowView<T, A> TRectMatrix<T, A>::at(size_t ind)
+{
+	if (pMem == nullptr) throw "pMem is nullptr";
+	if (ind >= nRows) throw out_of_range("index is out of range");
+	return this->operator[](ind);
+}
+
+template<typename T, typename A>
+inline TRowView<const T, A> TRectMatrix<T, A>::at(size_t ind) const
+{
+	if (pMem == nullptr) throw "pMem is nullptr";
+	if (ind >= nRows) throw out_of_range("index is out of range");
+	return this->operator[](ind);
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TRectMatrix<T, A>::Column(size_t j) const
+{
+	if (j >= nCols) throw out_of_range("index is out of range");
+	TDynamicVector<T, A> tmp(nRows, TUninitialized(), get_allocator());
+	for (size_t i = 0; i < nRows; i++)
+		tmp[i] = pMem[i * nCols + j];
+	return tmp;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>::operator TDynamicMatrix<T, A>() const
+{
+	if (nRows != nCols) throw "Matrix is not square";
+	TDynamicMatrix<T, A> tmp(nRows, TUninitialized(), get_allocator());
+	std::copy(pMem, pMem + nRows * nCols, &tmp[0][0]);
+	return tmp;
+}
+
+template<typename T, typename A>
+inline void TRectMatrix<T, A>::Transposed(TRectMatrix& dst) const
+{
+	if (dst.nRows != nCols || dst.nCols != nRows) throw "Sizes are not equal";
+	if (&dst == this)
+		TransposeInPlace(dst.pMem, nRows);
+	else
+		TransposeInto(pMem, dst.pMem, nRows, nCols);
+}
+
+template<typename T, typename A>
+inline bool TRectMatrix<T, A>::operator==(const TRectMatrix& m) const noexcept
+{
+	if (nRows != m.nRows || nCols != m.nCols)
+		return false;
+	return this->TDynamicVector<T, A>::operator==(m);
+}
+
+template<typename T, typename A>
+inline bool TRectMatrix<T, A>::operator!=(const TRectMatrix& m) const noexcept
+{
+	return !(this->operator==(m));
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>& TRectMatrix<T, A>::operator*=(const T& val)
+{
+	return *this = *this * val;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A>& TRectMatrix<T, A>::operator/=(const T& val)
+{
+	return *this = *this / val;
+}
+
+template<typename T, typename A>
+template<typename X, typename>
+inline TRectMatrix<T, A>& TRectMatrix<T, A>::operator+=(const X& m)
+{
+	return *this = *this + m;
+}
+
+template<typename T, typename A>
+template<typename X, typename>
+inline TRectMatrix<T, A>& TRectMatrix<T, A>::operator-=(const X& m)
+{
+	return *this = *this - m;
+}
+
+//       
+template<typename T, typename A>
+inline TDynamicVector<T, A> TRectMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
+{
+	if (nCols != v.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> tmp(nRows, TUninitialized(), get_allocator());
+	const T* a = pMem;
+	const T* x = &v[0];
+	T* y = &tmp[0];
+	const size_t n = nCols;
+	ParallelChunks(nRows, nCols, [a, x, y, n](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const T* row = a + i * n;
+			if constexpr (TSimdSupported<T>::value)
+				y[i] = SimdKernels<T>().dot(row, x, n);
+			else
+			{
+				T s = T();
+				for (size_t j = 0; j < n; j++)
+					s = s + row[j] * x[j];
+				y[i] = s;
+			}
+		}
+	});
+	return tmp;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A> TRectMatrix<T, A>::operator*(const TRectMatrix& m) const
+{
+	if (nCols != m.nRows) throw "Sizes are not equal";
+	TRectMatrix tmp(nRows, m.nCols, TUninitialized(), get_allocator());
+	Gemm(nRows, m.nCols, nCols, pMem, nCols, m.pMem, m.nCols, tmp.pMem, m.nCols, false);
+	return tmp;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A> TRectMatrix<T, A>::operator*(const TDynamicMatrix<T, A>& m) const
+{
+	if (nCols != m.size()) throw "Sizes are not equal";
+	TRectMatrix tmp(nRows, nCols, TUninitialized(), get_allocator());
+	Gemm(nRows, nCols, nCols, pMem, nCols, &m[0][0], nCols, tmp.pMem, nCols, false);
+	return tmp;
+}
+
+template<typename T, typename A>
+inline TRectMatrix<T, A> operator*(const TDynamicMatrix<T, A>& a, const TRectMatrix<T, A>& b)
+{
+	const size_t n = a.size();
+	if (n != b.rows()) throw "Sizes are not equal";
+	TRectMatrix<T, A> tmp(n, b.cols(), TUninitialized(), a.get_allocator());
+	Gemm(n, b.cols(), n, &a[0][0], n, &b[0][0], b.cols(), &tmp[0][0], b.cols(), false);
+	return tmp;
+}
+
+#endif
@@ -0,0 +1,248 @@
+// , ,  "   "
+//
+//
+//
+//
+
+#ifndef __TSparseMatrix_H__
+#define __TSparseMatrix_H__
+
+#include "tmatrix.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+//   n x n   CSR:    i
+//   val[rowPtr[i] .. rowPtr[i + 1])    
+// colInd.        nnz
+template<typename T, typename A = TAlignedAllocator<T>>
+class TSparseMatrix
+{
+protected:
+	//       A  size_t
+	typedef TDynamicVector<size_t, typename std::allocator_traits<A>::template rebind_alloc<size_t>> TIndexVector;
+
+	size_t sz;
+	size_t nz;
+	TIndexVector rowPtr;
+	//    1:  TDynamicVector   
+	TIndexVector colInd;
+	TDynamicVector<T, A> val;
+
+	static size_t CheckSize(size_t s);
+	static T Abs(const T& x) { return x < T() ? -x : x; }
+public:
+	TSparseMatrix(size_t s = 1, const A& alloc = A());
+	//   :    |a(i, j)| > tol
+	explicit TSparseMatrix(const TDynamicMatrix<T, A>& m, const T& tol = T());
+	//   (rows[k], cols[k], vals[k]);  
+	TSparseMatrix(size_t s, const TDynamicVector<size_t>& rows, const TDynamicVector<size_t>& cols, const TDynamicVector<T, A>& vals);
+
+	size_t size() const noexcept { return sz; }
+	size_t nnz() const noexcept { return nz; }
+	A get_allocator() const noexcept { return val.get_allocator(); }
+
+	//  (i, j),   ;    O(log)
+	T operator()(size_t i, size_t j) const;
+	T at(size_t i, size_t j) const;
+
+	explicit operator TDynamicMatrix<T, A>() const;
+
+	//  (   )
+	bool operator==(const TSparseMatrix& m) const noexcept;
+	bool operator!=(const TSparseMatrix& m) const noexcept;
+
+	// SpMV: O(nnz),     
+	TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
+	// SpMM: O(nnz * n),   -   B    A
+	TDynamicMatrix<T, A> operator*(const TDynamicMatrix<T, A>& m) const;
+
+	//   : , , 
+	friend ostream& operator<<(ostream& ostr, const TSparseMatrix& m)
+	{
+		for (size_t i = 0; i < m.sz; i++)
+			for (size_t k = m.rowPtr[i]; k < m.rowPtr[i + 1]; k++)
+				ostr << i << '\t' << m.colInd[k] << '\t' << m.val[k] << endl;
+		return ostr;
+	}
+};
+
+template<typename T, typename A>
+inline size_t TSparseMatrix<T, A>::CheckSize(size_t s)
+{
+	if (s == 0)
+		throw out_of_range("Size should be greater than zero");
+	if (s > MAX_VECTOR_SIZE)
+		throw out_of_range("Matrix size should be less than MAX_VECTOR_SIZE");
+	return s;
+}
+
+template<typename T, typename A>
+inline TSparseMatrix<T, A>::TSparseMatrix(size_t s, const A& alloc) : sz(CheckSize(s)), nz(0), rowPtr(s + 1, 0, alloc), colInd(1, 0, alloc), val(1, T(), alloc)
+{
+}
+
+template<typename T, typename A>
+inline TSparseMatrix<T, A>::TSparseMatrix(const TDynamicMatrix<T, A>& m, const T& tol) : sz(m.size()), nz(0), rowPtr(m.size() + 1, 0, m.get_allocator()), colInd(1, 0, m.get_allocator()), val(1, T(), m.get_allocator())
+{
+	for (size_t i = 0; i < sz; i++)
+		for (size_t j = 0; j < sz; j++)
+			if (tol < Abs(m[i][j]))
+				nz++;
+	colInd = TIndexVector(nz > 0 ? nz : 1, 0, get_allocator());
+	val = TDynamicVector<T, A>(nz > 0 ? nz : 1, T(), get_allocator());
+	size_t k = 0;
+	for (size_t i = 0; i < sz; i++)
+	{
+		for (size_t j = 0; j < sz; j++)
+			if (tol < Abs(m[i][j]))
+			{
+				colInd[k] = j;
+				val[k] = m[i][j];
+				k++;
+			}
+		rowPtr[i + 1] = k;
+	}
+}
+
+//     ,   
+//      
+template<typename T, typename A>
+inline TSparseMatrix<T, A>::TSparseMatrix(size_t s, const TDynamicVector<size_t>& rows, const TDynamicVector<size_t>& cols, const TDynamicVector<T, A>& vals) : sz(CheckSize(s)), nz(0), rowPtr(s + 1, 0, vals.get_allocator()), colInd(1, 0, vals.get_allocator()), val(1, T(), vals.get_allocator())
+{
+	const size_t n = rows.size();
+	if (cols.size() != n || vals.size() != n) throw "Sizes are not equal";
+	for (size_t k = 0; k < n; k++)
+	{
+		if (rows[k] >= sz || cols[k] >= sz) throw out_of_range("index is out of range");
+		rowPtr[rows[k] + 1]++;
+	}
+	for (size_t i = 0; i < sz; i++)
+		rowPtr[i + 1] += rowPtr[i];
+	TIndexVector next(rowPtr), order(n, 0, rowPtr.get_allocator());
+	for (size_t k = 0; k < n; k++)
+		order[next[rows[k]]++] = k;
+
+	colInd = TIndexVector(n, 0, rowPtr.get_allocator());
+	val = TDynamicVector<T, A>(n, T(), get_allocator());
+	size_t out = 0;
+	for (size_t i = 0; i < sz; i++)
+	{
+		size_t* first = &order[0] + rowPtr[i];
+		size_t* last = &order[0] + rowPtr[i + 1];
+		std::sort(first, last, [&](size_t a, size_t b) { return cols[a] < cols[b]; });
+		rowPtr[i] = out;
+		for (size_t* p = first; p != last; p++)
+		{
+			if (out > rowPtr[i] && colInd[out - 1] == cols[*p])
+				val[out - 1] = val[out - 1] + vals[*p];
+			else
+			{
+				colInd[out] = cols[*p];
+				val[out] = vals[*p];
+				out++;
+			}
+		}
+	}
+	rowPtr[sz] = out;
+	nz = out;
+}
+
+template<typename T, typename A>
+inline T TSparseMatrix<T, A>::operator()(size_t i, size_t j) const
+{
+	const size_t* first = &colInd[0] + rowPtr[i];
+	const size_t* last = &colInd[0] + rowPtr[i + 1];
+	const size_t* p = std::lower_bound(first, last, j);
+	if (p == last || *p != j)
+		return T();
+	return val[p - &colInd[0]];
+}
+
+template<typename T, typename A>
+inline T TSparseMatrix<T, A>::at(size_t i, size_t j) const
+{
+	if (i >= sz || j >= sz) throw out_of_range("index is out of range");
+	return this->operator()(i, j);
+}
+
+template<typename T, typename A>
+inline TSparseMatrix<T, A>::operator TDynamicMatrix<T, A>() const
+{
+	TDynamicMatrix<T, A> tmp(sz, T(), get_allocator());
+	for (size_t i = 0; i < sz; i++)
+		for (size_t k = rowPtr[i]; k < rowPtr[i + 1]; k++)
+			tmp[i][colInd[k]] = val[k];
+	return tmp;
+}
+
+template<typename T, typename A>
+inline bool TSparseMatrix<T, A>::operator==(const TSparseMatrix& m) const noexcept
+{
+	if (sz != m.sz || nz != m.nz || rowPtr != m.rowPtr)
+		return false;
+	for (size_t k = 0; k < nz; k++)
+		if (colInd[k] != m.colInd[k] || val[k] != m.val[k])
+			return false;
+	return true;
+}
+
+template<typename T, typename A>
+inline bool TSparseMatrix<T, A>::operator!=(const TSparseMatrix& m) const noexcept
+{
+	return !(this->operator==(m));
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TSparseMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
+{
+	if (sz != v.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> tmp(sz, TUninitialized(), get_allocator());
+	const size_t* rp = &rowPtr[0];
+	const size_t* ci = &colInd[0];
+	const T* a = &val[0];
+	const T* x = &v[0];
+	T* y = &tmp[0];
+	ParallelChunks(sz, nz / sz + 1, [rp, ci, a, x, y](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			T s = T();
+			for (size_t k = rp[i]; k < rp[i + 1]; k++)
+				s = s + a[k] * x[ci[k]];
+			y[i] = s;
+		}
+	});
+	return tmp;
+}
+
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TSparseMatrix<T, A>::operator*(const TDynamicMatrix<T, A>& m) const
+{
+	if (sz != m.size()) throw "Sizes are not equal";
+	TDynamicMatrix<T, A> tmp(sz, T(), get_allocator());
+	const size_t n = sz;
+	const size_t* rp = &rowPtr[0];
+	const size_t* ci = &colInd[0];
+	const T* a = &val[0];
+	const T* b = &m[0][0];
+	T* c = &tmp[0][0];
+	ParallelChunks(sz, (nz / sz + 1) * n, [n, rp, ci, a, b, c](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			T* ci_row = c + i * n;
+			for (size_t k = rp[i]; k < rp[i + 1]; k++)
+			{
+				const T aik = a[k];
+				const T* bk = b + ci[k] * n;
+				for (size_t j = 0; j < n; j++)
+					ci_row[j] = ci_row[j] + aik * bk[j];
+			}
+		}
+	});
+	return tmp;
+}
+
+#endif
@@ -12,19 +12,37 @@
 
 using namespace std;
 
-template<typename T>
-class TUTriangleMatrix : private TDynamicVector<TDynamicVector<T>>
+//  :   
+//    ,  i ( i..sz-1)   RowOffset(i)
+template<typename T, typename A = TAlignedAllocator<T>>
+class TUTriangleMatrix : private TDynamicVector<T, A>
 {
 protected:
-	using TDynamicVector<TDynamicVector<T>>::pMem;
-	using TDynamicVector<TDynamicVector<T>>::sz;
+	using TDynamicVector<T, A>::pMem;
+	size_t sz;
 
+	TUTriangleMatrix(size_t s, TDynamicVector<T, A>&& data) noexcept : TDynamicVector<T, A>(std::move(data)), sz(s) {}
+	static size_t CheckSize(size_t s);
+	size_t RowOffset(size_t i) const noexcept { return i * sz - i * (i - 1) / 2; }
+	TRowView<T, A> Row(size_t i) { return TRowView<T, A>(pMem + RowOffset(i), sz - i); }
+	TRowView<const T, A> Row(size_t i) const { return TRowView<const T, A>(pMem + RowOffset(i), sz - i); }
+
+	friend struct TExprAccess;
 public:
-	TUTriangleMatrix(size_t s = 2, const T& val = T());
+	typedef T value_type;
+	typedef A allocator_type;
+
+	TUTriangleMatrix(size_t s = 2, const T& val = T(), const A& alloc = A());
+	//    (texpr.h)   
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TUTriangleMatrix>::value>::type>
+	TUTriangleMatrix(const TExpr<E>& e) : TDynamicVector<T, A>(e, TExprFlat(), "utmatrix.expr_construct"), sz(e.self().dim()) {}
+	template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TUTriangleMatrix>::value>::type>
+	TUTriangleMatrix& operator=(const TExpr<E>& e);
 
-	using TDynamicVector<TDynamicVector<T>>::size;
-	//using TDynamicVector<TDynamicVector<T>>::operator[];
-	//using TDynamicVector<TDynamicVector<T>>::at;
+	size_t size() const noexcept { return sz; }
+	using TDynamicVector<T, A>::get_allocator;
+	//using TDynamicVector<TDynamicVector<T, A>>::operator[];
+	//using TDynamicVector<TDynamicVector<T, A>>::at;
 	T& operator()(size_t i, size_t j);
 	T& at(size_t i, size_t j);
 	const T& operator()(size_t i, size_t j) const;
@@ -34,23 +52,31 @@ public:
 	bool operator==(const TUTriangleMatrix& m) const noexcept;
 	bool operator!=(const TUTriangleMatrix& m) const noexcept;
 
-	//  
-	TUTriangleMatrix operator*(const T& val);
-	TUTriangleMatrix operator/(const T& val);
-	TUTriangleMatrix operator-(void);
+	//  ,    -   (texpr.h)
+
+	//    
+	TUTriangleMatrix& operator*=(const T& val);
+	TUTriangleMatrix& operator/=(const T& val);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TUTriangleMatrix, X>::value>::type>
+	TUTriangleMatrix& operator+=(const X& m);
+	template<typename X, typename = typename std::enable_if<TExprCompatible<TUTriangleMatrix, X>::value>::type>
+	TUTriangleMatrix& operator-=(const X& m);
+	TUTriangleMatrix& operator*=(const TUTriangleMatrix& m);
 
 	// - 
-	TDynamicVector<T> operator*(const TDynamicVector<T>& v);
+	TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
 
 	//  
-	TUTriangleMatrix operator+(const TUTriangleMatrix& m);
-	TUTriangleMatrix operator-(const TUTriangleMatrix& m);
-	TUTriangleMatrix operator*(const TUTriangleMatrix& m);
+	TUTriangleMatrix operator*(const TUTriangleMatrix& m) const;
+
+	//   (/ ); unitDiag -   
+	TDynamicVector<T, A> Solve(const TDynamicVector<T, A>& b, bool unitDiag = false) const;
+	TDynamicMatrix<T, A> Solve(const TDynamicMatrix<T, A>& b, bool unitDiag = false) const;
 
 	friend istream& operator>>(istream& istr, TUTriangleMatrix& m)
 	{
 		for (size_t i = 0; i < m.sz; i++)
-			istr >> m.pMem[i];
+			istr >> m.Row(i);
 		return istr;
 	}
 	friend ostream& operator<<(ostream& ostr, const TUTriangleMatrix& m)
@@ -60,142 +86,226 @@ public:
 			for (size_t j = 0; j < i; j++)
 				// ostr << '0' << ' ';
 				ostr << '0' << '\t';
-			ostr << m.pMem[i] << endl;
+			ostr << m.Row(i) << endl;
 		}
 		return ostr;
 	}
 };
 
-template<typename T>
-inline TUTriangleMatrix<T>::TUTriangleMatrix(size_t s, const T& val) : TDynamicVector<TDynamicVector<T>>(s)
+template<typename T, typename A>
+struct TIsExprContainer<TUTriangleMatrix<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+inline size_t TUTriangleMatrix<T, A>::CheckSize(size_t s)
 {
-	if (sz > MAX_MATRIX_SIZE)
+	if (s > MAX_MATRIX_SIZE)
 		throw out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
-	if (sz == 1)
+	if (s == 1)
 		throw "Triangle Matrix with size 1 doesn't make sense.";
-	for (size_t i = 0; i < sz; i++)
-		pMem[i] = TDynamicVector<T>(sz - i, val);
+	return s;
 }
 
-template<typename T>
-inline T& TUTriangleMatrix<T>::operator()(size_t i, size_t j)
+template<typename T, typename A>
+inline TUTriangleMatrix<T, A>::TUTriangleMatrix(size_t s, const T& val, const A& alloc) : TDynamicVector<T, A>(CheckSize(s) * (s + 1) / 2, val, alloc), sz(s)
 {
-	return pMem[i][j - i];
 }
 
-template<typename T>
-inline T& TUTriangleMatrix<T>::at(size_t i, size_t j)
+template<typename T, typename A>
+inline T& TUTriangleMatrix<T, A>::operator()(size_t i, size_t j)
+{
+	return pMem[RowOffset(i) + j - i];
+}
+
+template<typename T, typename A>
+inline T& TUTriangleMatrix<T, A>::at(size_t i, size_t j)
 {
 	if (pMem == nullptr) throw "pMem is nullptr";
-	if (i >= sz) throw out_of_range("index is out of range");
-	return pMem[i].at(j - i);
+	if (i >= sz || j < i || j >= sz) throw out_of_range("index is out of range");
+	return pMem[RowOffset(i) + j - i];
 }
 
-template<typename T>
-inline const T& TUTriangleMatrix<T>::operator()(size_t i, size_t j) const
+template<typename T, typename A>
+inline const T& TUTriangleMatrix<T, A>::operator()(size_t i, size_t j) const
 {
-	return pMem[i][j - i];
+	return pMem[RowOffset(i) + j - i];
 }
 
-template<typename T>
-inline const T& TUTriangleMatrix<T>::at(size_t i, size_t j) const
+template<typename T, typename A>
+inline const T& TUTriangleMatrix<T, A>::at(size_t i, size_t j) const
 {
 	if (pMem == nullptr) throw "pMem is nullptr";
-	if (i >= sz) throw out_of_range("index is out of range");
-	return pMem[i].at(j - i);
+	if (i >= sz || j < i || j >= sz) throw out_of_range("index is out of range");
+	return pMem[RowOffset(i) + j - i];
+}
+
+template<typename T, typename A>
+template<typename E, typename>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator=(const TExpr<E>& e)
+{
+	this->AssignExpr(e.self(), "utmatrix.expr_assign");
+	sz = e.self().dim();
+	return *this;
 }
 
-template<typename T>
-inline bool TUTriangleMatrix<T>::operator==(const TUTriangleMatrix<T>& m) const noexcept
+template<typename T, typename A>
+inline bool TUTriangleMatrix<T, A>::operator==(const TUTriangleMatrix<T, A>& m) const noexcept
 {
-	return this->TDynamicVector<TDynamicVector<T>>::operator==(m);
+	if (sz != m.sz)
+		return false;
+	return this->TDynamicVector<T, A>::operator==(m);
 }
 
-template<typename T>
-inline bool TUTriangleMatrix<T>::operator!=(const TUTriangleMatrix<T>& m) const noexcept
+template<typename T, typename A>
+inline bool TUTriangleMatrix<T, A>::operator!=(const TUTriangleMatrix<T, A>& m) const noexcept
 {
 	return !(this->operator==(m));
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator*(const T& val)
+template<typename T, typename A>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator*=(const T& val)
 {
-	TUTriangleMatrix tmp(*this);
-	for (size_t i = 0; i < sz; i++)
-	{
-		tmp[i] = tmp[i] * val;
-	}
-	return tmp;
+	return *this = *this * val;
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator/(const T& val)
+template<typename T, typename A>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator/=(const T& val)
 {
-	TUTriangleMatrix tmp(*this);
-	for (size_t i = 0; i < sz; i++)
-	{
-		tmp[i] = tmp[i] / val;
-	}
-	return tmp;
+	return *this = *this / val;
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator-(void)
+template<typename T, typename A>
+template<typename X, typename>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator+=(const X& m)
 {
-	TUTriangleMatrix<T> tmp(sz);
-	for (size_t i = 0; i < sz; i++)
-		tmp[i] = -(this->operator[](i));
-	return tmp;
+	return *this = *this + m;
 }
 
-template<typename T>
-inline TDynamicVector<T> TUTriangleMatrix<T>::operator*(const TDynamicVector<T>& v)
+template<typename T, typename A>
+template<typename X, typename>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator-=(const X& m)
 {
-	if (sz != v.size()) throw "Sizes are not equal";
-	TDynamicVector<T> tmp(sz);
+	return *this = *this - m;
+}
+
+//  i      i  *this
+//   k >= i  m:      
+//    ,  m    *this
+template<typename T, typename A>
+inline TUTriangleMatrix<T, A>& TUTriangleMatrix<T, A>::operator*=(const TUTriangleMatrix<T, A>& m)
+{
+	TAllocSite site("utmatrix.mul_assign");
+	if (sz != m.size()) throw "Sizes are not equal";
+	T* ci = TGemmWorkspace<T>::Local().Result(sz);
 	for (size_t i = 0; i < sz; i++)
 	{
-		for (size_t j = i; j < sz; j++)
+		T* ai = pMem + RowOffset(i);
+		std::fill(ci, ci + sz - i, T());
+		for (size_t k = i; k < sz; k++)
 		{
-			tmp[i] = tmp[i] + this->operator()(i, j) * v[j];
+			const T aik = ai[k - i];
+			const T* bk = m.pMem + m.RowOffset(k);
+			for (size_t j = k; j < sz; j++)
+				ci[j - i] = ci[j - i] + aik * bk[j - k];
 		}
+		std::copy(ci, ci + sz - i, ai);
 	}
-	return tmp;
+	return *this;
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator+(const TUTriangleMatrix& m)
+template<typename T, typename A>
+inline TDynamicVector<T, A> TUTriangleMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
 {
-	if (sz != m.size()) throw "Sizes are not equal";
-	TUTriangleMatrix tmp(sz);
+	TAllocSite site("utmatrix.mul_vector");
+	if (sz != v.size()) throw "Sizes are not equal";
+	TDynamicVector<T, A> tmp(sz, TUninitialized(), get_allocator());
 	for (size_t i = 0; i < sz; i++)
-		tmp[i] = this->operator[](i) + m[i];
+	{
+		const T* row = pMem + RowOffset(i);
+		T s = T();
+		for (size_t j = i; j < sz; j++)
+			s = s + row[j - i] * v[j];
+		tmp[i] = s;
+	}
 	return tmp;
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator-(const TUTriangleMatrix& m)
+template<typename T, typename A>
+inline TUTriangleMatrix<T, A> TUTriangleMatrix<T, A>::operator*(const TUTriangleMatrix& m) const
 {
-
+	TAllocSite site("utmatrix.mul_matrix");
 	if (sz != m.size()) throw "Sizes are not equal";
-	TUTriangleMatrix tmp(sz);
+	TUTriangleMatrix tmp(sz, T(), get_allocator());
 	for (size_t i = 0; i < sz; i++)
-		tmp[i] = this->operator[](i) - m[i];
+	{
+		const T* ai = pMem + RowOffset(i);
+		T* ci = tmp.pMem + RowOffset(i);
+		for (size_t k = i; k < sz; k++)
+		{
+			const T aik = ai[k - i];
+			const T* bk = m.pMem + m.RowOffset(k);
+			for (size_t j = k; j < sz; j++)
+				ci[j - i] = ci[j - i] + aik * bk[j - k];
+		}
+	}
 	return tmp;
 }
 
-template<typename T>
-inline TUTriangleMatrix<T> TUTriangleMatrix<T>::operator*(const TUTriangleMatrix& m)
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TUTriangleMatrix<T, A>::Solve(const TDynamicVector<T, A>& b, bool unitDiag) const
 {
-	if (sz != m.size()) throw "Sizes are not equal";
-	TUTriangleMatrix tmp(sz);
-	for (size_t i = 0; i < sz; i++)
-		for (size_t j = i; j < sz; j++)
-			for (size_t k = i; k < sz; k++)
-				if (k <= j)
-					tmp(i, j) = tmp(i, j) + this->operator()(i, k) * m(k, j);
-	return tmp;
+	TAllocSite site("utmatrix.solve_vector");
+	if (sz != b.size()) throw "Sizes are not equal";
+	if (!unitDiag)
+		for (size_t i = 0; i < sz; i++)
+			if (pMem[RowOffset(i)] == T())
+				throw "Can't solve system with singular matrix.";
+	TDynamicVector<T, A> x(b);
+	for (size_t i = sz; i-- > 0;)
+	{
+		const T* row = pMem + RowOffset(i);
+		T s = x[i];
+		for (size_t j = i + 1; j < sz; j++)
+			s = s - row[j - i] * x[j];
+		x[i] = unitDiag ? s : s / row[0];
+	}
+	return x;
 }
 
+//      TRSM_BLOCK ,
+//        
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TUTriangleMatrix<T, A>::Solve(const TDynamicMatrix<T, A>& b, bool unitDiag) const
+{
+	TAllocSite site("utmatrix.solve_matrix");
+	if (sz != b.size()) throw "Sizes are not equal";
+	if (!unitDiag)
+		for (size_t i = 0; i < sz; i++)
+			if (pMem[RowOffset(i)] == T())
+				throw "Can't solve system with singular matrix.";
+	const size_t TRSM_BLOCK = 256;
+	TDynamicMatrix<T, A> x(b);
+	T* px = &x[0][0];
+	for (size_t c0 = 0; c0 < sz; c0 += TRSM_BLOCK)
+	{
+		const size_t c1 = c0 + TRSM_BLOCK < sz ? c0 + TRSM_BLOCK : sz;
+		for (size_t i = sz; i-- > 0;)
+		{
+			const T* row = pMem + RowOffset(i);
+			T* xi = px + i * sz;
+			for (size_t j = i + 1; j < sz; j++)
+			{
+				const T f = row[j - i];
+				const T* xj = px + j * sz;
+				for (size_t c = c0; c < c1; c++)
+					xi[c] = xi[c] - f * xj[c];
+			}
+			if (!unitDiag)
+				for (size_t c = c0; c < c1; c++)
+					xi[c] = xi[c] / row[0];
+		}
+	}
+	return x;
+}
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Распределители памяти контейнеров
+
+#ifndef __TAlloc_H__
+#define __TAlloc_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+const size_t MEM_ALIGNMENT = 64;
+
+// Распределитель по умолчанию: память выровнена на Align байт
+// (не меньше выравнивания T), что нужно векторным ядрам (tsimd.h)
+// и исключает разделение строки кэша между соседними буферами
+template<typename T, size_t Align = MEM_ALIGNMENT>
+class TAlignedAllocator
+{
+public:
+  typedef T value_type;
+  static constexpr size_t alignment = Align < alignof(T) ? alignof(T) : Align;
+
+  template<typename U>
+  struct rebind { typedef TAlignedAllocator<U, Align> other; };
+
+  TAlignedAllocator() noexcept = default;
+  template<typename U>
+  TAlignedAllocator(const TAlignedAllocator<U, Align>&) noexcept {}
+
+  T* allocate(size_t n)
+  {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+  }
+  void deallocate(T* p, size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t(alignment));
+  }
+
+  template<typename U>
+  bool operator==(const TAlignedAllocator<U, Align>&) const noexcept { return true; }
+  template<typename U>
+  bool operator!=(const TAlignedAllocator<U, Align>&) const noexcept { return false; }
+};
+
+// Признак конструктора, который не инициализирует элементы
+// тривиальных типов (для буферов, которые сразу перезаписываются)
+struct TUninitialized {};
+
+// Распределитель в контейнере: пустой (без состояния) хранится базовым
+// классом и не увеличивает размер контейнера, остальные - полем
+template<typename A, bool = std::is_empty<A>::value && !std::is_final<A>::value>
+class TAllocHolder : private A
+{
+public:
+  explicit TAllocHolder(const A& a) noexcept : A(a) {}
+  A& Alloc() noexcept { return *this; }
+  const A& Alloc() const noexcept { return *this; }
+};
+
+template<typename A>
+class TAllocHolder<A, false>
+{
+  A alloc;
+public:
+  explicit TAllocHolder(const A& a) noexcept : alloc(a) {}
+  A& Alloc() noexcept { return alloc; }
+  const A& Alloc() const noexcept { return alloc; }
+};
+
+// Контейнеры получают распределитель параметром шаблона A (стандартный
+// интерфейс allocate/deallocate и std::allocator_traits), например для
+// памяти из пула, арены или на больших страницах. Экземпляр распределителя
+// передается конструктору (по умолчанию A()) и хранится в контейнере;
+// копирование, перемещение и обмен контейнеров следуют правилам
+// propagate_on_container_* распределителя, присваивание в существующий
+// контейнер без propagate сохраняет его распределитель. Результаты
+// операций и выражений (texpr.h) получают распределитель левого операнда,
+// строка матрицы (TRowView) распределителя не хранит и дает вектор с A()
+template<typename T, typename A = TAlignedAllocator<T>> class TDynamicVector;
+template<typename T, typename A = TAlignedAllocator<T>> class TDynamicMatrix;
+template<typename T, typename A = TAlignedAllocator<typename std::remove_const<T>::type>> class TRowView;
+
+#endif
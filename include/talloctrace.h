@@ -0,0 +1,82 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Диагностика выделений памяти контейнерами по местам вызова
+
+#ifndef __TAllocTrace_H__
+#define __TAllocTrace_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// При сборке с MP2_ALLOC_TRACE (cmake -DMP2_ALLOC_TRACE=ON) каждое
+// выделение буфера контейнера (TDynamicVector::Allocate - общее для всех
+// контейнеров) записывается на место вызова: операцию, отмеченную
+// TAllocSite (matrix.mul_matrix, utmatrix.solve_vector, ...; действует
+// самая внутренняя отметка потока), а вне отмеченных операций - на
+// конструктор буфера (vector.ctor, vector.copy, expr.construct, ...);
+// поэлементные выражения матриц записываются на контейнер результата
+// (matrix.expr_construct, utmatrix.expr_assign, ...).
+// Для места накапливаются число выделений и освобождений, байты, время
+// жизни буферов и пик одновременно живых байтов; сводка печатается
+// в stderr при завершении программы.
+// Без MP2_ALLOC_TRACE функции учета пустые, TAllocSite - пустой класс
+
+// Итог по одному месту вызова
+struct TAllocSiteStats
+{
+  std::string site;
+  uint64_t allocs = 0;
+  uint64_t frees = 0;
+  uint64_t bytes = 0;
+  uint64_t liveBytes = 0;
+  uint64_t peakLiveBytes = 0;
+  // время жизни освобожденных буферов
+  uint64_t lifetimeNs = 0;
+  uint64_t maxLifetimeNs = 0;
+};
+
+// Итоги по местам (по убыванию числа выделений) и пик живых байтов всех мест
+std::vector<TAllocSiteStats> AllocTraceResults();
+uint64_t AllocTracePeakLiveBytes();
+void AllocTraceReset();
+void AllocTracePrint(std::ostream& os);
+// Печать сводки при завершении (по умолчанию включена)
+void AllocTraceSetExitReport(bool enable);
+
+#ifdef MP2_ALLOC_TRACE
+
+// Отметка операции: выделения в потоке до уничтожения объекта
+// записываются на name (строковый литерал)
+class TAllocSite
+{
+  const char* prev;
+public:
+  explicit TAllocSite(const char* name) noexcept;
+  ~TAllocSite();
+  TAllocSite(const TAllocSite&) = delete;
+  TAllocSite& operator=(const TAllocSite&) = delete;
+};
+
+// fallback - место для выделений вне отмеченных операций
+void AllocTraceAlloc(const void* p, size_t bytes, const char* fallback) noexcept;
+void AllocTraceFree(const void* p) noexcept;
+
+#else
+
+class TAllocSite
+{
+public:
+  explicit TAllocSite(const char*) noexcept {}
+};
+
+inline void AllocTraceAlloc(const void*, size_t, const char*) noexcept {}
+inline void AllocTraceFree(const void*) noexcept {}
+
+#endif
+
+#endif
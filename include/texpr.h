@@ -0,0 +1,618 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Шаблоны выражений: ленивые поэлементные операции над векторами и матрицами
+
+#ifndef __TExpr_H__
+#define __TExpr_H__
+
+#include "talloc.h"
+#include "tsimd.h"
+#include "tparallel.h"
+#include "tstats.h"
+#include "tprofile.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+template<typename X> class TExprSlice;
+template<typename C> struct TExprIndex;
+
+// Выражение a + b - c * 2 не вычисляется сразу: операторы строят дерево
+// из узлов, которые хранят указатели на данные операндов. Присваивание
+// контейнеру (или его конструирование из выражения) проходит по памяти
+// один раз, без промежуточных объектов.
+// result_type узла - тип контейнера, который получится в результате;
+// операнды бинарных операций должны иметь одинаковый result_type и размер
+// (dim() - размер контейнера или число строк матрицы, count() - число
+// хранимых элементов, shape() - дополнительный размер из TExprShape).
+// Выражение ссылается на данные операндов, поэтому операнды должны
+// существовать до присваивания выражения.
+// ops и loads узла - число операций и листьев на один элемент
+// результата (для счетчиков tstats.h); flat(i) - элемент i буфера
+// результата.
+// Выражение можно использовать вместо контейнера-результата: size()
+// и operator[] у него такие же, как у result_type (строка матрицы -
+// выражение над ее элементами), а остальные методы result_type и
+// произведения вычисляют выражение во временный контейнер (Eval).
+
+// Базовый класс узлов (CRTP)
+template<typename E>
+struct TExpr
+{
+  const E& self() const noexcept { return static_cast<const E&>(*this); }
+
+  auto Eval() const { return typename E::result_type(self()); }
+
+  size_t size() const noexcept { return self().dim(); }
+  template<typename X = E>
+  auto operator[](size_t i) const -> decltype(TExprIndex<typename X::result_type>::Get(std::declval<const X&>(), i))
+  {
+    return TExprIndex<typename X::result_type>::Get(self(), i);
+  }
+  template<typename X = E>
+  auto at(size_t i) const -> decltype(std::declval<const X&>()[i])
+  {
+    if (i >= size()) throw std::out_of_range("index is out of range");
+    return (*this)[i];
+  }
+
+  template<typename X = E>
+  auto Det() const -> decltype(std::declval<const typename X::result_type&>().Det()) { return Eval().Det(); }
+  template<typename X = E>
+  auto Minor(size_t i, size_t j) const -> decltype(std::declval<const typename X::result_type&>().Minor(i, j)) { return Eval().Minor(i, j); }
+  template<typename X = E>
+  auto Cofactor(size_t i, size_t j) const -> decltype(std::declval<const typename X::result_type&>().Cofactor(i, j)) { return Eval().Cofactor(i, j); }
+  template<typename X = E>
+  auto Invertible() const -> decltype(std::declval<const typename X::result_type&>().Invertible()) { return Eval().Invertible(); }
+  template<typename B, typename X = E>
+  auto Solve(const B& b) const -> decltype(std::declval<const typename X::result_type&>().Solve(b)) { return Eval().Solve(b); }
+  template<typename B, typename X = E>
+  auto Solve(const B& b, bool unitDiag) const -> decltype(std::declval<const typename X::result_type&>().Solve(b, unitDiag)) { return Eval().Solve(b, unitDiag); }
+};
+
+// Признак конструктора, вычисляющего выражение в плоский буфер
+// независимо от его result_type (используют производные контейнеры)
+struct TExprFlat {};
+
+// Доступ к данным контейнеров (контейнеры объявляют его другом)
+struct TExprAccess
+{
+  template<typename C>
+  static const typename C::value_type* Data(const C& c) noexcept
+  {
+    return static_cast<const TDynamicVector<typename C::value_type, typename C::allocator_type>&>(c).pMem;
+  }
+  template<typename C>
+  static size_t Count(const C& c) noexcept
+  {
+    return static_cast<const TDynamicVector<typename C::value_type, typename C::allocator_type>&>(c).sz;
+  }
+  template<typename C>
+  static const typename C::allocator_type* Alloc(const C& c) noexcept
+  {
+    return &static_cast<const TDynamicVector<typename C::value_type, typename C::allocator_type>&>(c).Alloc();
+  }
+};
+
+// Дополнительный размер контейнера, который не выводится из size()
+// и числа элементов (например, ширина ленты); по умолчанию 0
+template<typename C>
+struct TExprShape
+{
+  static size_t Of(const C&) noexcept { return 0; }
+};
+
+// Контейнеры, которые могут быть листьями выражений
+// (специализации рядом с объявлением каждого контейнера)
+template<typename C> struct TIsExprContainer : std::false_type {};
+
+template<typename X> struct TIsExprNode : std::is_base_of<TExpr<X>, X> {};
+
+// Векторы (с любым распределителем)
+template<typename C> struct TExprIsVector : std::false_type {};
+template<typename T, typename A> struct TExprIsVector<TDynamicVector<T, A>> : std::true_type {};
+
+// operator[] выражения с результатом C (как operator[] контейнера C);
+// у контейнеров без operator[] специализации нет
+template<typename C> struct TExprIndex {};
+
+template<typename T, typename A>
+struct TExprIndex<TDynamicVector<T, A>>
+{
+  template<typename X>
+  static typename X::value_type Get(const X& e, size_t i) { return e.flat(i); }
+};
+
+// Лист: данные контейнера и его распределитель (у строк матриц его нет)
+template<typename C>
+class TExprLeaf : public TExpr<TExprLeaf<C>>
+{
+public:
+  typedef C result_type;
+  typedef typename C::value_type value_type;
+  typedef typename C::allocator_type allocator_type;
+  static constexpr size_t ops = 0;
+  static constexpr size_t loads = 1;
+
+  const value_type* p;
+  size_t n;
+  size_t d;
+  size_t s;
+  const allocator_type* a;
+
+  TExprLeaf(const value_type* _p, size_t _n, size_t _d, size_t _s = 0, const allocator_type* _a = nullptr) noexcept : p(_p), n(_n), d(_d), s(_s), a(_a) {}
+
+  value_type flat(size_t i) const { return p[i]; }
+  size_t count() const noexcept { return n; }
+  size_t dim() const noexcept { return d; }
+  size_t shape() const noexcept { return s; }
+  allocator_type allocator() const { return a != nullptr ? *a : allocator_type(); }
+};
+
+// Приведение операнда к узлу выражения
+template<typename X, typename = void>
+struct TExprOperand : std::false_type {};
+
+template<typename X>
+struct TExprOperand<X, typename std::enable_if<TIsExprNode<X>::value>::type> : std::true_type
+{
+  typedef X type;
+  static const X& Make(const X& x) noexcept { return x; }
+};
+
+template<typename X>
+struct TExprOperand<X, typename std::enable_if<TIsExprContainer<X>::value>::type> : std::true_type
+{
+  typedef TExprLeaf<X> type;
+  static type Make(const X& x) noexcept { return type(TExprAccess::Data(x), TExprAccess::Count(x), x.size(), TExprShape<X>::Of(x), TExprAccess::Alloc(x)); }
+};
+
+template<typename T, typename A>
+struct TExprOperand<TRowView<T, A>, void> : std::true_type
+{
+  typedef TExprLeaf<TDynamicVector<typename std::remove_const<T>::type, A>> type;
+  static type Make(const TRowView<T, A>& r) noexcept { return type(r.data(), r.size(), r.size()); }
+};
+
+template<typename X>
+using TExprOf = typename TExprOperand<X>::type;
+
+// Операции (в форме a = a + b, как и в остальной библиотеке)
+struct TExprAdd
+{
+  template<typename T> static T Apply(const T& a, const T& b) { return a + b; }
+  template<typename T> static auto Kernel(const TSimdKernels<T>& k) { return k.add; }
+  template<typename T> static auto ScalarKernel(const TSimdKernels<T>& k) { return k.addScalar; }
+};
+
+struct TExprSub
+{
+  template<typename T> static T Apply(const T& a, const T& b) { return a - b; }
+  template<typename T> static auto Kernel(const TSimdKernels<T>& k) { return k.sub; }
+  template<typename T> static auto ScalarKernel(const TSimdKernels<T>& k) { return k.subScalar; }
+};
+
+struct TExprMul
+{
+  template<typename T> static T Apply(const T& a, const T& b) { return a * b; }
+  template<typename T> static auto ScalarKernel(const TSimdKernels<T>& k) { return k.mulScalar; }
+};
+
+struct TExprDiv
+{
+  template<typename T> static T Apply(const T& a, const T& b) { return a / b; }
+  template<typename T> static auto ScalarKernel(const TSimdKernels<T>& k) { return k.divScalar; }
+};
+
+// Узел: поэлементная операция над двумя выражениями
+template<typename Op, typename L, typename R>
+class TExprBinary : public TExpr<TExprBinary<Op, L, R>>
+{
+public:
+  typedef typename L::result_type result_type;
+  typedef typename L::value_type value_type;
+  static constexpr size_t ops = L::ops + R::ops + 1;
+  static constexpr size_t loads = L::loads + R::loads;
+
+  L l;
+  R r;
+
+  TExprBinary(const L& _l, const R& _r) : l(_l), r(_r) {}
+
+  value_type flat(size_t i) const { return Op::Apply(l.flat(i), r.flat(i)); }
+  size_t count() const noexcept { return l.count(); }
+  size_t dim() const noexcept { return l.dim(); }
+  size_t shape() const noexcept { return l.shape(); }
+  // результат получает распределитель левого листа
+  auto allocator() const { return l.allocator(); }
+};
+
+// Узел: операция над выражением и скаляром
+template<typename Op, typename L>
+class TExprScalar : public TExpr<TExprScalar<Op, L>>
+{
+public:
+  typedef typename L::result_type result_type;
+  typedef typename L::value_type value_type;
+  static constexpr size_t ops = L::ops + 1;
+  static constexpr size_t loads = L::loads;
+
+  L l;
+  value_type val;
+
+  TExprScalar(const L& _l, const value_type& _val) : l(_l), val(_val) {}
+
+  value_type flat(size_t i) const { return Op::Apply(l.flat(i), val); }
+  size_t count() const noexcept { return l.count(); }
+  size_t dim() const noexcept { return l.dim(); }
+  size_t shape() const noexcept { return l.shape(); }
+  // результат получает распределитель левого листа
+  auto allocator() const { return l.allocator(); }
+};
+
+// Узел: унарный минус
+template<typename L>
+class TExprNeg : public TExpr<TExprNeg<L>>
+{
+public:
+  typedef typename L::result_type result_type;
+  typedef typename L::value_type value_type;
+  static constexpr size_t ops = L::ops + 1;
+  static constexpr size_t loads = L::loads;
+
+  L l;
+
+  TExprNeg(const L& _l) : l(_l) {}
+
+  value_type flat(size_t i) const { return -l.flat(i); }
+  size_t count() const noexcept { return l.count(); }
+  size_t dim() const noexcept { return l.dim(); }
+  size_t shape() const noexcept { return l.shape(); }
+  // результат получает распределитель левого листа
+  auto allocator() const { return l.allocator(); }
+};
+
+// Узел: строка выражения-матрицы - count элементов начиная с begin
+// (TExprIndex контейнеров со строками)
+template<typename X>
+class TExprSlice : public TExpr<TExprSlice<X>>
+{
+public:
+  typedef typename X::value_type value_type;
+  typedef TDynamicVector<value_type, typename X::result_type::allocator_type> result_type;
+  static constexpr size_t ops = X::ops;
+  static constexpr size_t loads = X::loads;
+
+  X e;
+  size_t begin;
+  size_t n;
+
+  TExprSlice(const X& _e, size_t _begin, size_t _n) : e(_e), begin(_begin), n(_n) {}
+
+  value_type flat(size_t i) const { return e.flat(begin + i); }
+  size_t count() const noexcept { return n; }
+  size_t dim() const noexcept { return n; }
+  size_t shape() const noexcept { return 0; }
+  auto allocator() const { return e.allocator(); }
+};
+
+// Простые узлы над листьями вычисляются векторными ядрами (tsimd.h)
+template<typename E>
+struct TExprSimd : std::false_type {};
+
+template<typename Op, typename C>
+struct TExprSimd<TExprBinary<Op, TExprLeaf<C>, TExprLeaf<C>>> : TSimdSupported<typename C::value_type>
+{
+  template<typename T>
+  static void Run(T* dst, const TExprBinary<Op, TExprLeaf<C>, TExprLeaf<C>>& e, size_t begin, size_t end)
+  {
+    Op::Kernel(SimdKernels<T>())(e.l.p + begin, e.r.p + begin, dst + begin, end - begin);
+  }
+};
+
+template<typename Op, typename C>
+struct TExprSimd<TExprScalar<Op, TExprLeaf<C>>> : TSimdSupported<typename C::value_type>
+{
+  template<typename T>
+  static void Run(T* dst, const TExprScalar<Op, TExprLeaf<C>>& e, size_t begin, size_t end)
+  {
+    Op::ScalarKernel(SimdKernels<T>())(e.l.p + begin, e.val, dst + begin, end - begin);
+  }
+};
+
+template<typename C>
+struct TExprSimd<TExprNeg<TExprLeaf<C>>> : TSimdSupported<typename C::value_type>
+{
+  template<typename T>
+  static void Run(T* dst, const TExprNeg<TExprLeaf<C>>& e, size_t begin, size_t end)
+  {
+    SimdKernels<T>().neg(e.l.p + begin, dst + begin, end - begin);
+  }
+};
+
+// Вычисление элементов [begin, end) выражения в память dst
+template<typename T, typename E>
+inline void ExprAssignRange(T* dst, const E& e, size_t begin, size_t end)
+{
+  if constexpr (TExprSimd<E>::value)
+    TExprSimd<E>::Run(dst, e, begin, end);
+  else
+    for (size_t i = begin; i < end; i++)
+      dst[i] = e.flat(i);
+}
+
+// Учет вычисления выражения в счетчиках потока (tstats.h)
+template<typename T, typename E>
+inline void ExprCount(const E& e)
+{
+  const uint64_t n = e.count();
+  StatsCount(E::ops * n, E::loads * n * sizeof(T), n * sizeof(T));
+}
+
+// Вычисление выражения в память dst (e.count() элементов) за один проход;
+// большие выражения делятся на порции между потоками пула (tparallel.h).
+// dst может совпадать с данными операнда: каждый элемент результата
+// зависит только от элементов операндов с тем же номером
+template<typename T, typename E>
+inline void ExprAssign(T* dst, const E& e)
+{
+  TProfileScope profile("expr.assign");
+  ExprCount<T>(e);
+  ParallelChunks(e.count(), 1, [dst, &e](size_t begin, size_t end) { ExprAssignRange(dst, e, begin, end); });
+}
+
+// Вычисление выражения в неинициализированную память dst: элементы
+// тривиальных типов просто записываются (как в ExprAssign),
+// остальные создаются конструктором копирования по одному
+template<typename T, typename E>
+inline void ExprConstruct(T* dst, const E& e)
+{
+  if constexpr (std::is_trivial<T>::value)
+    ExprAssign(dst, e);
+  else
+  {
+    ExprCount<T>(e);
+    size_t i = 0;
+    try
+    {
+      for (; i < e.count(); i++)
+        ::new (static_cast<void*>(dst + i)) T(e.flat(i));
+    }
+    catch (...)
+    {
+      std::destroy_n(dst, i);
+      throw;
+    }
+  }
+}
+
+// Проверки для выбора перегрузок (std::conjunction не трогает TExprOf
+// для типов, которые не являются операндами выражений)
+template<typename L, typename R>
+struct TExprSameResult : std::is_same<typename TExprOf<L>::result_type, typename TExprOf<R>::result_type> {};
+
+template<typename L, typename R>
+struct TExprCompatible : std::conjunction<TExprOperand<L>, TExprOperand<R>, TExprSameResult<L, R>> {};
+
+template<typename L>
+struct TExprVectorResult : TExprIsVector<typename TExprOf<L>::result_type> {};
+
+template<typename L>
+struct TExprVector : std::conjunction<TExprOperand<L>, TExprVectorResult<L>> {};
+
+template<typename L, typename R>
+inline void ExprCheckSizes(const L& l, const R& r)
+{
+  if (l.dim() != r.dim() || l.count() != r.count() || l.shape() != r.shape()) throw "Sizes are not equal";
+}
+
+// векторные и матричные поэлементные операции
+template<typename L, typename R, typename = typename std::enable_if<TExprCompatible<L, R>::value>::type>
+inline TExprBinary<TExprAdd, TExprOf<L>, TExprOf<R>> operator+(const L& l, const R& r)
+{
+  TExprOf<L> el = TExprOperand<L>::Make(l);
+  TExprOf<R> er = TExprOperand<R>::Make(r);
+  ExprCheckSizes(el, er);
+  return TExprBinary<TExprAdd, TExprOf<L>, TExprOf<R>>(el, er);
+}
+
+template<typename L, typename R, typename = typename std::enable_if<TExprCompatible<L, R>::value>::type>
+inline TExprBinary<TExprSub, TExprOf<L>, TExprOf<R>> operator-(const L& l, const R& r)
+{
+  TExprOf<L> el = TExprOperand<L>::Make(l);
+  TExprOf<R> er = TExprOperand<R>::Make(r);
+  ExprCheckSizes(el, er);
+  return TExprBinary<TExprSub, TExprOf<L>, TExprOf<R>>(el, er);
+}
+
+template<typename L, typename = typename std::enable_if<TExprOperand<L>::value>::type>
+inline TExprNeg<TExprOf<L>> operator-(const L& l)
+{
+  return TExprNeg<TExprOf<L>>(TExprOperand<L>::Make(l));
+}
+
+// скалярные операции
+template<typename L, typename = typename std::enable_if<TExprOperand<L>::value>::type>
+inline TExprScalar<TExprMul, TExprOf<L>> operator*(const L& l, const typename TExprOf<L>::value_type& val)
+{
+  return TExprScalar<TExprMul, TExprOf<L>>(TExprOperand<L>::Make(l), val);
+}
+
+template<typename L, typename = typename std::enable_if<TExprOperand<L>::value>::type>
+inline TExprScalar<TExprDiv, TExprOf<L>> operator/(const L& l, const typename TExprOf<L>::value_type& val)
+{
+  return TExprScalar<TExprDiv, TExprOf<L>>(TExprOperand<L>::Make(l), val);
+}
+
+// сложение и вычитание скаляра - только для векторов
+// (у треугольных матриц нули не хранятся)
+template<typename L, typename = typename std::enable_if<TExprVector<L>::value>::type>
+inline TExprScalar<TExprAdd, TExprOf<L>> operator+(const L& l, const typename TExprOf<L>::value_type& val)
+{
+  return TExprScalar<TExprAdd, TExprOf<L>>(TExprOperand<L>::Make(l), val);
+}
+
+template<typename L, typename = typename std::enable_if<TExprVector<L>::value>::type>
+inline TExprScalar<TExprSub, TExprOf<L>> operator-(const L& l, const typename TExprOf<L>::value_type& val)
+{
+  return TExprScalar<TExprSub, TExprOf<L>>(TExprOperand<L>::Make(l), val);
+}
+
+// Операции с временным контейнером (например, результатом умножения
+// матриц) записывают результат в его буфер и возвращают его, а не строят
+// выражение: (a * b) + c + d не выделяет память после умножения.
+// C - тип контейнера-rvalue (для lvalue C выводится как ссылка и не подходит)
+template<typename C, typename X>
+struct TExprRvalue : std::conjunction<TIsExprContainer<C>, TExprCompatible<C, X>> {};
+
+template<typename C, typename X>
+struct TExprRvalueRight : std::conjunction<TIsExprContainer<C>, std::negation<TIsExprContainer<X>>,
+  TExprCompatible<typename std::decay<X>::type, C>> {};
+
+template<typename C, typename R, typename = typename std::enable_if<TExprRvalue<C, R>::value>::type>
+inline C operator+(C&& l, const R& r)
+{
+  l += r;
+  return std::move(l);
+}
+
+template<typename C, typename R, typename = typename std::enable_if<TExprRvalue<C, R>::value>::type>
+inline C operator-(C&& l, const R& r)
+{
+  l -= r;
+  return std::move(l);
+}
+
+// правый операнд временный, левый - нет (иначе выбирается перегрузка выше)
+template<typename L, typename C, typename = typename std::enable_if<TExprRvalueRight<C, L>::value>::type>
+inline C operator+(L&& l, C&& r)
+{
+  r = l + r;
+  return std::move(r);
+}
+
+template<typename L, typename C, typename = typename std::enable_if<TExprRvalueRight<C, L>::value>::type>
+inline C operator-(L&& l, C&& r)
+{
+  r = l - r;
+  return std::move(r);
+}
+
+template<typename C, typename = typename std::enable_if<TIsExprContainer<C>::value>::type>
+inline C operator-(C&& l)
+{
+  l = -l;
+  return std::move(l);
+}
+
+template<typename C, typename = typename std::enable_if<TIsExprContainer<C>::value>::type>
+inline C operator*(C&& l, const typename TExprOf<C>::value_type& val)
+{
+  l *= val;
+  return std::move(l);
+}
+
+template<typename C, typename = typename std::enable_if<TIsExprContainer<C>::value>::type>
+inline C operator/(C&& l, const typename TExprOf<C>::value_type& val)
+{
+  l /= val;
+  return std::move(l);
+}
+
+template<typename C, typename = typename std::enable_if<std::conjunction<TIsExprContainer<C>, TExprVector<C>>::value>::type>
+inline C operator+(C&& l, const typename TExprOf<C>::value_type& val)
+{
+  l += val;
+  return std::move(l);
+}
+
+template<typename C, typename = typename std::enable_if<std::conjunction<TIsExprContainer<C>, TExprVector<C>>::value>::type>
+inline C operator-(C&& l, const typename TExprOf<C>::value_type& val)
+{
+  l -= val;
+  return std::move(l);
+}
+
+// скалярное произведение векторов (вычисляется сразу)
+template<typename L, typename R, typename = typename std::enable_if<std::conjunction<TExprVector<L>, TExprCompatible<L, R>>::value>::type>
+inline typename TExprOf<L>::value_type operator*(const L& l, const R& r)
+{
+  typedef typename TExprOf<L>::value_type T;
+  TExprOf<L> el = TExprOperand<L>::Make(l);
+  TExprOf<R> er = TExprOperand<R>::Make(r);
+  ExprCheckSizes(el, er);
+  TProfileScope profile("vector.dot");
+  StatsCount((TExprOf<L>::ops + TExprOf<R>::ops + 2) * uint64_t(el.count()),
+    (TExprOf<L>::loads + TExprOf<R>::loads) * uint64_t(el.count()) * sizeof(T), 0);
+  if constexpr (TSimdSupported<T>::value && std::is_same<TExprOf<L>, TExprOf<R>>::value &&
+    std::is_same<TExprOf<L>, TExprLeaf<typename TExprOf<L>::result_type>>::value)
+    return SimdKernels<T>().dot(el.p, er.p, el.count());
+  else
+  {
+    T tmp = T();
+    for (size_t i = 0; i < el.count(); i++)
+      tmp = tmp + el.flat(i) * er.flat(i);
+    return tmp;
+  }
+}
+
+// Произведения и деление матриц, в которых хотя бы один операнд -
+// выражение: выражение вычисляется во временный контейнер
+template<typename X, typename = typename std::enable_if<!TIsExprNode<X>::value>::type>
+inline const X& ExprEval(const X& x) noexcept
+{
+  return x;
+}
+
+template<typename E>
+inline auto ExprEval(const TExpr<E>& e)
+{
+  return e.self().Eval();
+}
+
+template<typename L, typename R>
+struct TExprEvalOperands : std::conjunction<TExprOperand<L>, TExprOperand<R>,
+  std::disjunction<TIsExprNode<L>, TIsExprNode<R>>, std::negation<TExprVector<L>>> {};
+
+template<typename L, typename R, typename = typename std::enable_if<TExprEvalOperands<L, R>::value>::type>
+inline auto operator*(const L& l, const R& r) -> decltype(ExprEval(l) * ExprEval(r))
+{
+  return ExprEval(l) * ExprEval(r);
+}
+
+template<typename L, typename R, typename = typename std::enable_if<TExprEvalOperands<L, R>::value>::type>
+inline auto operator/(const L& l, const R& r) -> decltype(ExprEval(l) / ExprEval(r))
+{
+  return ExprEval(l) / ExprEval(r);
+}
+
+// сравнение выражения с выражением или контейнером
+// (сравнение двух контейнеров выполняют их собственные операторы)
+template<typename L, typename R, typename = typename std::enable_if<std::conjunction<TExprCompatible<L, R>,
+  std::disjunction<TIsExprNode<L>, TIsExprNode<R>>>::value>::type>
+inline bool operator==(const L& l, const R& r)
+{
+  TExprOf<L> el = TExprOperand<L>::Make(l);
+  TExprOf<R> er = TExprOperand<R>::Make(r);
+  if (el.dim() != er.dim() || el.count() != er.count() || el.shape() != er.shape())
+    return false;
+  StatsCount((TExprOf<L>::ops + TExprOf<R>::ops) * uint64_t(el.count()),
+    (TExprOf<L>::loads + TExprOf<R>::loads) * uint64_t(el.count()) * sizeof(typename TExprOf<L>::value_type), 0);
+  for (size_t i = 0; i < el.count(); i++)
+    if (el.flat(i) != er.flat(i))
+      return false;
+  return true;
+}
+
+template<typename L, typename R, typename = typename std::enable_if<std::conjunction<TExprCompatible<L, R>,
+  std::disjunction<TIsExprNode<L>, TIsExprNode<R>>>::value>::type>
+inline bool operator!=(const L& l, const R& r)
+{
+  return !(l == r);
+}
+
+#endif
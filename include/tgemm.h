@@ -0,0 +1,353 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Умножение матриц (C += A * B) с блокированием под кэш
+
+#ifndef __TGemm_H__
+#define __TGemm_H__
+
+#include "tvector.h"
+#include "tparallel.h"
+#include "tstats.h"
+#include "tprofile.h"
+#include <algorithm>
+#include <type_traits>
+
+using namespace std;
+
+// Параметры блокирования:
+// MR x NR - плитка C, которая накапливается в регистрах,
+// KC x NR - панель B, которая помещается в L1,
+// MC x KC - блок A, который помещается в L2,
+// KC x NC - блок B, который помещается в L3
+template<typename T>
+struct TGemmBlocking
+{
+  static constexpr size_t MR = 4;
+  static constexpr size_t NR = MEM_ALIGNMENT / sizeof(T) < 4 ? 4 : MEM_ALIGNMENT / sizeof(T);
+  static constexpr size_t KC = 256;
+  static constexpr size_t MC = 128;
+  static constexpr size_t NC = 2048;
+};
+
+// Рабочие буферы умножения, свои у каждого потока: растут до самого
+// большого запрошенного размера и не освобождаются, поэтому повторные
+// умножения (в том числе *= в итерационных циклах) не выделяют память
+template<typename T>
+class TGemmWorkspace
+{
+  TDynamicVector<T> packA, packB, result;
+
+  static T* Reserve(TDynamicVector<T>& buf, size_t n)
+  {
+    if (buf.size() < n)
+      buf = TDynamicVector<T>(n, TUninitialized());
+    return &buf[0];
+  }
+public:
+  T* PackA(size_t n) { return Reserve(packA, n); }
+  T* PackB(size_t n) { return Reserve(packB, n); }
+  // буфер для результата операций на месте
+  T* Result(size_t n) { return Reserve(result, n); }
+
+  static TGemmWorkspace& Local()
+  {
+    thread_local TGemmWorkspace w;
+    return w;
+  }
+};
+
+// Упаковка блока A (mc x kc) полосами по MR строк,
+// недостающие строки дополняются нулями
+template<typename T>
+inline void GemmPackA(size_t mc, size_t kc, const T* a, size_t lda, T* buf)
+{
+  const size_t MR = TGemmBlocking<T>::MR;
+  for (size_t i = 0; i < mc; i += MR)
+  {
+    const size_t m = mc - i < MR ? mc - i : MR;
+    for (size_t p = 0; p < kc; p++)
+    {
+      for (size_t r = 0; r < m; r++)
+        buf[r] = a[(i + r) * lda + p];
+      for (size_t r = m; r < MR; r++)
+        buf[r] = T();
+      buf += MR;
+    }
+  }
+}
+
+// Упаковка блока B (kc x nc) полосами по NR столбцов,
+// недостающие столбцы дополняются нулями
+template<typename T>
+inline void GemmPackB(size_t kc, size_t nc, const T* b, size_t ldb, T* buf)
+{
+  const size_t NR = TGemmBlocking<T>::NR;
+  for (size_t j = 0; j < nc; j += NR)
+  {
+    const size_t n = nc - j < NR ? nc - j : NR;
+    for (size_t p = 0; p < kc; p++)
+    {
+      const T* row = b + p * ldb + j;
+      for (size_t c = 0; c < n; c++)
+        buf[c] = row[c];
+      for (size_t c = n; c < NR; c++)
+        buf[c] = T();
+      buf += NR;
+    }
+  }
+}
+
+// Микроядро: плитка MR x NR накапливается в локальном массиве
+// (в регистрах) и добавляется к C (или записывается в C при store) только
+// в конце; m x n - реальный размер плитки на границе матрицы
+template<typename T>
+inline void GemmMicroKernel(size_t kc, const T* a, const T* b, T* c, size_t ldc, size_t m, size_t n, bool store)
+{
+  const size_t MR = TGemmBlocking<T>::MR;
+  const size_t NR = TGemmBlocking<T>::NR;
+  T acc[MR][NR] = {};
+  for (size_t p = 0; p < kc; p++)
+  {
+    for (size_t i = 0; i < MR; i++)
+    {
+      const T ai = a[i];
+      for (size_t j = 0; j < NR; j++)
+        acc[i][j] += ai * b[j];
+    }
+    a += MR;
+    b += NR;
+  }
+  if (store)
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++)
+        c[i * ldc + j] = acc[i][j];
+  else
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++)
+        c[i * ldc + j] += acc[i][j];
+}
+
+// Построчное умножение для маленьких матриц и неарифметических T
+template<typename T>
+inline void GemmSimple(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, bool accumulate = true)
+{
+  for (size_t i = 0; i < M; i++)
+  {
+    T* ci = c + i * ldc;
+    if (!accumulate)
+      std::fill(ci, ci + N, T());
+    for (size_t p = 0; p < K; p++)
+    {
+      const T aip = a[i * lda + p];
+      const T* bp = b + p * ldb;
+      for (size_t j = 0; j < N; j++)
+        ci[j] = ci[j] + aip * bp[j];
+    }
+  }
+}
+
+// при accumulate == false первый блок по K записывает плитки C, а не
+// добавляет к ним, поэтому C может быть не инициализирована
+template<typename T>
+inline void GemmBlocked(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, bool accumulate = true)
+{
+  typedef TGemmBlocking<T> B;
+  const size_t nc0 = N < B::NC ? N : B::NC;
+  const size_t kc0 = K < B::KC ? K : B::KC;
+  const size_t mc0 = M < B::MC ? M : B::MC;
+  TGemmWorkspace<T>& ws = TGemmWorkspace<T>::Local();
+  T* pa = ws.PackA(((mc0 + B::MR - 1) / B::MR) * B::MR * kc0);
+  T* pb = ws.PackB(((nc0 + B::NR - 1) / B::NR) * B::NR * kc0);
+
+  for (size_t jc = 0; jc < N; jc += B::NC)
+  {
+    const size_t nc = N - jc < B::NC ? N - jc : B::NC;
+    for (size_t pc = 0; pc < K; pc += B::KC)
+    {
+      const size_t kc = K - pc < B::KC ? K - pc : B::KC;
+      GemmPackB(kc, nc, b + pc * ldb + jc, ldb, pb);
+      for (size_t ic = 0; ic < M; ic += B::MC)
+      {
+        const size_t mc = M - ic < B::MC ? M - ic : B::MC;
+        GemmPackA(mc, kc, a + ic * lda + pc, lda, pa);
+        for (size_t jr = 0; jr < nc; jr += B::NR)
+        {
+          const size_t n = nc - jr < B::NR ? nc - jr : B::NR;
+          for (size_t ir = 0; ir < mc; ir += B::MR)
+          {
+            const size_t m = mc - ir < B::MR ? mc - ir : B::MR;
+            GemmMicroKernel(kc, pa + ir * kc, pb + jr * kc, c + (ic + ir) * ldc + jc + jr, ldc, m, n, !accumulate && pc == 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+// Параллельное умножение: C делится на плитки из целых блоков по MC строк
+// (или мельче, чтобы плиток хватило на все потоки) и NC столбцов;
+// каждая плитка считается GemmBlocked в своем потоке со своими буферами
+template<typename T>
+inline void GemmParallel(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t threads, bool accumulate = true)
+{
+  typedef TGemmBlocking<T> B;
+  size_t mt = (M + 2 * threads - 1) / (2 * threads);
+  mt = ((mt + B::MR - 1) / B::MR) * B::MR;
+  if (mt > B::MC)
+    mt = B::MC;
+  const size_t rowTiles = (M + mt - 1) / mt;
+  const size_t colTiles = (N + B::NC - 1) / B::NC;
+  ParallelFor(rowTiles * colTiles, [=](size_t t)
+  {
+    const size_t i = (t % rowTiles) * mt;
+    const size_t j = (t / rowTiles) * B::NC;
+    const size_t m = M - i < mt ? M - i : mt;
+    const size_t n = N - j < B::NC ? N - j : B::NC;
+    GemmBlocked(m, n, K, a + i * lda, lda, b + j, ldb, c + i * ldc + j, ldc, accumulate);
+  });
+}
+
+// Режим умножения (определен в src/tgemm.cpp): параллельно в пуле потоков
+// (по умолчанию) или последовательно в вызывающем потоке
+bool GemmParallelEnabled();
+void GemmSetParallel(bool enable);
+
+// Умножение Штрассена-Винограда (определено в src/tgemm.cpp): по умолчанию
+// выключено; после GemmSetStrassen(true) применяется к матрицам с плавающей
+// точкой, у которых все размеры не меньше порога (2048). Оно меняет
+// результат operator*: суммы вычисляются в другом порядке и через разности
+// блоков, поэтому ошибка оценивается нормой ||A|| * ||B|| и растет с
+// глубиной рекурсии, а не покомпонентно |A| * |B|, как у обычного умножения
+bool GemmStrassenEnabled();
+void GemmSetStrassen(bool enable);
+size_t GemmStrassenCutoff();
+void GemmSetStrassenCutoff(size_t cutoff);
+
+// Обычное умножение C += A * B (C = A * B при accumulate == false) за O(M * N * K)
+template<typename T>
+inline void GemmClassic(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, bool accumulate = true)
+{
+  const size_t GEMM_MIN_BLOCKED_SIZE = 32;
+  if constexpr (std::is_arithmetic<T>::value)
+  {
+    if (M >= GEMM_MIN_BLOCKED_SIZE && N >= GEMM_MIN_BLOCKED_SIZE && K >= GEMM_MIN_BLOCKED_SIZE)
+    {
+      // меньше ~2 млн умножений не окупают раздачу задания потокам
+      const double GEMM_MIN_PARALLEL_WORK = 2e6;
+      const size_t threads = GemmParallelEnabled() ? ParallelThreadCount() : 1;
+      if (threads > 1 && double(M) * N * K >= GEMM_MIN_PARALLEL_WORK)
+        GemmParallel(M, N, K, a, lda, b, ldb, c, ldc, threads, accumulate);
+      else
+        GemmBlocked(M, N, K, a, lda, b, ldb, c, ldc, accumulate);
+      return;
+    }
+  }
+  GemmSimple(M, N, K, a, lda, b, ldb, c, ldc, accumulate);
+}
+
+// z = x + y или z = x - y для блоков m x n (z может совпадать с x)
+template<typename T>
+inline void GemmCombine(size_t m, size_t n, const T* x, size_t ldx, const T* y, size_t ldy, T* z, size_t ldz, bool sub)
+{
+  for (size_t i = 0; i < m; i++)
+  {
+    const T* xi = x + i * ldx;
+    const T* yi = y + i * ldy;
+    T* zi = z + i * ldz;
+    if (sub)
+      for (size_t j = 0; j < n; j++)
+        zi[j] = xi[j] - yi[j];
+    else
+      for (size_t j = 0; j < n; j++)
+        zi[j] = xi[j] + yi[j];
+  }
+}
+
+// C += A * B по схеме Штрассена-Винограда: 7 умножений половинных блоков
+// вместо 8 и 15 сложений. Рекурсия идет, пока все размеры не меньше cutoff,
+// листья считает GemmClassic. Нечетные размеры не дополняются нулями:
+// последние строка/столбец отщепляются и досчитываются обычным умножением
+template<typename T>
+void GemmStrassen(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t cutoff)
+{
+  if (M < cutoff || N < cutoff || K < cutoff)
+  {
+    GemmClassic(M, N, K, a, lda, b, ldb, c, ldc);
+    return;
+  }
+  const size_t m = M / 2, n = N / 2, k = K / 2;
+  const T *a11 = a, *a12 = a + k, *a21 = a + m * lda, *a22 = a21 + k;
+  const T *b11 = b, *b12 = b + n, *b21 = b + k * ldb, *b22 = b21 + n;
+  T *c11 = c, *c12 = c + n, *c21 = c + m * ldc, *c22 = c21 + n;
+  TDynamicVector<T> sa(m * k, TUninitialized()), tb(k * n, TUninitialized()), p(m * n), q(m * n);
+  T *s = &sa[0], *t = &tb[0], *p0 = &p[0], *q0 = &q[0];
+
+  // P1 = A11 B11, C11 += P1 + P2, где P2 = A12 B21
+  GemmStrassen(m, n, k, a11, lda, b11, ldb, p0, n, cutoff);
+  GemmCombine(m, n, c11, ldc, p0, n, c11, ldc, false);
+  GemmStrassen(m, n, k, a12, lda, b21, ldb, c11, ldc, cutoff);
+  // S2 = A21 + A22 - A11, T2 = B22 - B12 + B11, p = P1 + P6, где P6 = S2 T2
+  GemmCombine(m, k, a21, lda, a22, lda, s, k, false);
+  GemmCombine(m, k, s, k, a11, lda, s, k, true);
+  GemmCombine(k, n, b22, ldb, b12, ldb, t, n, true);
+  GemmCombine(k, n, t, n, b11, ldb, t, n, false);
+  GemmStrassen(m, n, k, s, k, t, n, p0, n, cutoff);
+  // C21 -= P4, где P4 = A22 T4, T4 = T2 - B21
+  GemmCombine(k, n, b21, ldb, t, n, t, n, true);
+  GemmStrassen(m, n, k, a22, lda, t, n, c21, ldc, cutoff);
+  // C12 += P1 + P6 + P3, где P3 = S4 B22, S4 = A12 - S2
+  GemmCombine(m, n, c12, ldc, p0, n, c12, ldc, false);
+  GemmCombine(m, k, a12, lda, s, k, s, k, true);
+  GemmStrassen(m, n, k, s, k, b22, ldb, c12, ldc, cutoff);
+  // p = P1 + P6 + P7, где P7 = S3 T3, S3 = A11 - A21, T3 = B22 - B12;
+  // C21 += p, C22 += p
+  GemmCombine(m, k, a11, lda, a21, lda, s, k, true);
+  GemmCombine(k, n, b22, ldb, b12, ldb, t, n, true);
+  GemmStrassen(m, n, k, s, k, t, n, p0, n, cutoff);
+  GemmCombine(m, n, c21, ldc, p0, n, c21, ldc, false);
+  GemmCombine(m, n, c22, ldc, p0, n, c22, ldc, false);
+  // P5 = S1 T1, S1 = A21 + A22, T1 = B12 - B11; C12 += P5, C22 += P5
+  GemmCombine(m, k, a21, lda, a22, lda, s, k, false);
+  GemmCombine(k, n, b12, ldb, b11, ldb, t, n, true);
+  GemmStrassen(m, n, k, s, k, t, n, q0, n, cutoff);
+  GemmCombine(m, n, c12, ldc, q0, n, c12, ldc, false);
+  GemmCombine(m, n, c22, ldc, q0, n, c22, ldc, false);
+
+  // отщепленные края: последний столбец A и строка B для четной части C,
+  // затем последний столбец и последняя строка C целиком
+  const size_t M2 = 2 * m, N2 = 2 * n, K2 = 2 * k;
+  if (K2 < K)
+    GemmClassic(M2, N2, 1, a + K2, lda, b + K2 * ldb, ldb, c, ldc);
+  if (N2 < N)
+    GemmClassic(M, 1, K, a, lda, b + N2, ldb, c + N2, ldc);
+  if (M2 < M)
+    GemmClassic(1, N2, K, a + M2 * lda, lda, b, ldb, c + M2 * ldc, ldc);
+}
+
+// C += A * B, где A - M x K, B - K x N, C - M x N,
+// все матрицы хранятся построчно с шагами строк lda, ldb, ldc;
+// при accumulate == false C = A * B и C не нужно заранее обнулять
+template<typename T>
+inline void Gemm(size_t M, size_t N, size_t K, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, bool accumulate = true)
+{
+  TProfileScope profile("gemm");
+  StatsCount(2 * uint64_t(M) * N * K, (uint64_t(M) * K + uint64_t(K) * N + (accumulate ? uint64_t(M) * N : 0)) * sizeof(T),
+    uint64_t(M) * N * sizeof(T));
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    const size_t cutoff = GemmStrassenCutoff();
+    if (GemmStrassenEnabled() && M >= cutoff && N >= cutoff && K >= cutoff)
+    {
+      if (!accumulate)
+        for (size_t i = 0; i < M; i++)
+          std::fill(c + i * ldc, c + i * ldc + N, T());
+      GemmStrassen(M, N, K, a, lda, b, ldb, c, ldc, cutoff);
+      return;
+    }
+  }
+  GemmClassic(M, N, K, a, lda, b, ldb, c, ldc, accumulate);
+}
+
+#endif
@@ -0,0 +1,202 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// LU-разложение и решение систем линейных уравнений
+
+#ifndef __TLU_H__
+#define __TLU_H__
+
+#include "tvector.h"
+#include "tparallel.h"
+#include "tstats.h"
+#include "tprofile.h"
+#include <algorithm>
+#include <type_traits>
+
+using namespace std;
+
+// Разложение квадратной матрицы a (n x n, построчно) на месте: PA = LU.
+// Для нецелых T - метод Гаусса с выбором ведущего элемента по столбцу:
+// под диагональю остаются множители L (с единичной диагональю), на и над ней - U.
+// Для целых T - метод Барейса (исключение без дробей): над и на диагонали
+// остаются элементы приведенной матрицы, под диагональю - ведущие столбцы
+// каждого шага; все деления выполняются нацело, и a[n - 1][n - 1] = det(PA).
+// perm (может быть nullptr) получает номера исходных строк.
+// Возвращает знак перестановки (1 или -1) или 0 для вырожденной матрицы
+template<typename T>
+inline int LUFactor(T* a, size_t n, size_t* perm)
+{
+  TProfileScope profile("lu.factor");
+  StatsCount(2 * uint64_t(n) * n * n / 3, uint64_t(n) * n * sizeof(T), uint64_t(n) * n * sizeof(T));
+  if (perm != nullptr)
+    for (size_t i = 0; i < n; i++)
+      perm[i] = i;
+  int sign = 1;
+  T prev = 1;
+  for (size_t k = 0; k < n; k++)
+  {
+    T* rk = a + k * n;
+    size_t p = k;
+    if constexpr (std::is_integral<T>::value)
+    {
+      while (p < n && a[p * n + k] == 0)
+        p++;
+      if (p == n)
+        return 0;
+    }
+    else
+    {
+      T pmax = rk[k] < T() ? -rk[k] : rk[k];
+      for (size_t i = k + 1; i < n; i++)
+      {
+        const T v = a[i * n + k];
+        const T av = v < T() ? -v : v;
+        if (pmax < av)
+        {
+          pmax = av;
+          p = i;
+        }
+      }
+      if (pmax == T())
+        return 0;
+    }
+    if (p != k)
+    {
+      std::swap_ranges(rk, rk + n, a + p * n);
+      if (perm != nullptr)
+        std::swap(perm[k], perm[p]);
+      sign = -sign;
+    }
+    // строки под ведущей обновляются независимо
+    ParallelChunks(n - k - 1, n - k, [&](size_t begin, size_t end)
+    {
+      for (size_t i = k + 1 + begin; i < k + 1 + end; i++)
+      {
+        T* ri = a + i * n;
+        if constexpr (std::is_integral<T>::value)
+        {
+          for (size_t j = k + 1; j < n; j++)
+            ri[j] = (ri[j] * rk[k] - ri[k] * rk[j]) / prev;
+        }
+        else
+        {
+          const T f = ri[k] / rk[k];
+          ri[k] = f;
+          for (size_t j = k + 1; j < n; j++)
+            ri[j] = ri[j] - f * rk[j];
+        }
+      }
+    });
+    prev = rk[k];
+  }
+  return sign;
+}
+
+// Определитель по результату LUFactor
+template<typename T>
+inline T LUDet(const T* lu, size_t n, int sign)
+{
+  if (sign == 0)
+    return T();
+  StatsCount(n, n * sizeof(T), 0);
+  T d;
+  if constexpr (std::is_integral<T>::value)
+    d = lu[n * n - 1];
+  else
+  {
+    d = 1;
+    for (size_t k = 0; k < n; k++)
+      d = d * lu[k * n + k];
+  }
+  return sign > 0 ? d : -d;
+}
+
+// Решение системы по результату LUFactor для m правых частей:
+// b - матрица n x m (построчно), строки берутся в порядке perm,
+// решение записывается в x (n x m). Для целых T решение вычисляется
+// точно, если оно целое, иначе округляется к нулю
+template<typename T>
+inline void LUSolve(const T* lu, size_t n, const size_t* perm, const T* b, T* x, size_t m)
+{
+  TProfileScope profile("lu.solve");
+  StatsCount(2 * uint64_t(n) * n * m, (uint64_t(n) * n + uint64_t(n) * m) * sizeof(T), uint64_t(n) * m * sizeof(T));
+  for (size_t i = 0; i < n; i++)
+    std::copy(b + perm[i] * m, b + perm[i] * m + m, x + i * m);
+
+  // правые части независимы: столбцы делятся между потоками пула
+  ParallelChunks(m, n * n, [&](size_t c0, size_t c1)
+  {
+    if constexpr (std::is_integral<T>::value)
+    {
+      // повтор шагов Барейса над правыми частями
+      T prev = 1;
+      for (size_t k = 0; k < n; k++)
+      {
+        const T pk = lu[k * n + k];
+        const T* xk = x + k * m;
+        for (size_t i = k + 1; i < n; i++)
+        {
+          const T f = lu[i * n + k];
+          T* xi = x + i * m;
+          for (size_t c = c0; c < c1; c++)
+            xi[c] = (xi[c] * pk - f * xk[c]) / prev;
+        }
+        prev = pk;
+      }
+      // обратный ход для y = det * x, который всегда целый
+      const T d = lu[n * n - 1];
+      for (size_t i = n; i-- > 0;)
+      {
+        const T* ri = lu + i * n;
+        T* xi = x + i * m;
+        for (size_t c = c0; c < c1; c++)
+          xi[c] = xi[c] * d;
+        for (size_t j = i + 1; j < n; j++)
+        {
+          const T* xj = x + j * m;
+          for (size_t c = c0; c < c1; c++)
+            xi[c] = xi[c] - ri[j] * xj[c];
+        }
+        for (size_t c = c0; c < c1; c++)
+          xi[c] = xi[c] / ri[i];
+      }
+      for (size_t i = 0; i < n; i++)
+        for (size_t c = c0; c < c1; c++)
+          x[i * m + c] = x[i * m + c] / d;
+    }
+    else
+    {
+      // прямой ход: L y = P b
+      for (size_t i = 1; i < n; i++)
+      {
+        const T* ri = lu + i * n;
+        T* xi = x + i * m;
+        for (size_t j = 0; j < i; j++)
+        {
+          const T f = ri[j];
+          const T* xj = x + j * m;
+          for (size_t c = c0; c < c1; c++)
+            xi[c] = xi[c] - f * xj[c];
+        }
+      }
+      // обратный ход: U x = y
+      for (size_t i = n; i-- > 0;)
+      {
+        const T* ri = lu + i * n;
+        T* xi = x + i * m;
+        for (size_t j = i + 1; j < n; j++)
+        {
+          const T f = ri[j];
+          const T* xj = x + j * m;
+          for (size_t c = c0; c < c1; c++)
+            xi[c] = xi[c] - f * xj[c];
+        }
+        for (size_t c = c0; c < c1; c++)
+          xi[c] = xi[c] / ri[i];
+      }
+    }
+  });
+}
+
+#endif
@@ -8,7 +8,12 @@
 #define __TDynamicMatrix_H__
 
 #include "tvector.h"
+#include "tgemm.h"
+#include "tlu.h"
+#include "ttranspose.h"
 #include <iostream>
+#include <algorithm>
+#include <type_traits>
 
 using namespace std;
 
@@ -17,20 +22,45 @@ const size_t MAX_MATRIX_SIZE = 10000;
 
 // Динамическая матрица - 
 // шаблонная матрица на динамической памяти
-template<typename T>
-class TDynamicMatrix : private TDynamicVector<TDynamicVector<T>>
+// (все элементы хранятся построчно в одном непрерывном буфере,
+// который выделяет распределитель A)
+template<typename T, typename A>
+class TDynamicMatrix : private TDynamicVector<T, A>
 {
 protected:
-  using TDynamicVector<TDynamicVector<T>>::pMem;
-  using TDynamicVector<TDynamicVector<T>>::sz;
+  using TDynamicVector<T, A>::pMem;
+  size_t sz;
+
+  TDynamicMatrix(size_t s, TDynamicVector<T, A>&& data) noexcept : TDynamicVector<T, A>(std::move(data)), sz(s) {}
+  static size_t CheckSize(size_t s);
+
+  friend struct TExprAccess;
 public:
-  TDynamicMatrix(size_t s = 1, const T& val = T());
+  typedef T value_type;
+  typedef A allocator_type;
+
+  TDynamicMatrix(size_t s = 1, const T& val = T(), const A& alloc = A());
+  // без инициализации элементов тривиальных типов (см. TDynamicVector)
+  TDynamicMatrix(size_t s, TUninitialized, const A& alloc = A());
+  // вычисление поэлементного выражения (texpr.h) за один проход
+  template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDynamicMatrix>::value>::type>
+  TDynamicMatrix(const TExpr<E>& e) : TDynamicVector<T, A>(e, TExprFlat(), "matrix.expr_construct"), sz(e.self().dim()) {}
+  template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDynamicMatrix>::value>::type>
+  TDynamicMatrix& operator=(const TExpr<E>& e);
 
-  using TDynamicVector<TDynamicVector<T>>::size;
-  using TDynamicVector<TDynamicVector<T>>::operator[];
-  using TDynamicVector<TDynamicVector<T>>::at;
+  size_t size() const noexcept { return sz; }
+  using TDynamicVector<T, A>::get_allocator;
+
+  // индексация
+  TRowView<T, A> operator[](size_t ind) { return TRowView<T, A>(pMem + ind * sz, sz); }
+  TRowView<const T, A> operator[](size_t ind) const { return TRowView<const T, A>(pMem + ind * sz, sz); }
+  // индексация с контролем
+  TRowView<T, A> at(size_t ind);
+  TRowView<const T, A> at(size_t ind) const;
 
   void Transpose();
+  // запись транспонированной матрицы в dst того же размера
+  void Transposed(TDynamicMatrix& dst) const;
   TDynamicMatrix Cofactor(size_t i, size_t j) const;
   T Det() const;
   T Minor(size_t i, size_t j) const;
@@ -40,60 +70,129 @@ public:
   bool operator==(const TDynamicMatrix& m) const noexcept;
   bool operator!=(const TDynamicMatrix& m) const noexcept;
 
-  // матрично-скалярные операции
-  TDynamicMatrix operator*(const T& val);
-  TDynamicMatrix operator/(const T& val);
-  TDynamicMatrix operator-(void);
+  // матрично-скалярные операции, сложение и вычитание - шаблоны выражений (texpr.h)
+
+  // составное присваивание на месте
+  TDynamicMatrix& operator*=(const T& val);
+  TDynamicMatrix& operator/=(const T& val);
+  template<typename X, typename = typename std::enable_if<TExprCompatible<TDynamicMatrix, X>::value>::type>
+  TDynamicMatrix& operator+=(const X& m);
+  template<typename X, typename = typename std::enable_if<TExprCompatible<TDynamicMatrix, X>::value>::type>
+  TDynamicMatrix& operator-=(const X& m);
+  TDynamicMatrix& operator*=(const TDynamicMatrix& m);
 
   // матрично-векторные операции
-  TDynamicVector<T> operator*(const TDynamicVector<T>& v);
+  TDynamicVector<T, A> operator*(const TDynamicVector<T, A>& v) const;
 
   // матрично-матричные операции
-  TDynamicMatrix operator+(const TDynamicMatrix& m);
-  TDynamicMatrix operator-(const TDynamicMatrix& m);
-  TDynamicMatrix operator*(const TDynamicMatrix& m);
-  TDynamicMatrix operator/(const TDynamicMatrix& m);
+  TDynamicMatrix operator*(const TDynamicMatrix& m) const;
+  TDynamicMatrix operator/(const TDynamicMatrix& m) const;
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicMatrix& m)
   {
     for (size_t i = 0; i < m.sz; i++)
-      istr >> m.pMem[i];
+      istr >> m[i];
     return istr;
   }
   friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& m)
   {
     for (size_t i = 0; i < m.sz; i++)
-      ostr << m.pMem[i] << endl;
+      ostr << m[i] << endl;
     return ostr;
   }
 };
 
-template<typename T>
-inline TDynamicMatrix<T>::TDynamicMatrix(size_t s, const T& val) : TDynamicVector<TDynamicVector<T>>(s)
+template<typename T, typename A>
+struct TIsExprContainer<TDynamicMatrix<T, A>> : std::true_type {};
+
+// строка i выражения-матрицы
+template<typename T, typename A>
+struct TExprIndex<TDynamicMatrix<T, A>>
+{
+  template<typename X>
+  static TExprSlice<X> Get(const X& e, size_t i) { return TExprSlice<X>(e, i * e.dim(), e.dim()); }
+};
+
+// Решение систем A * x = b и A * X = B через LU-разложение (без обращения A)
+template<typename T, typename Alloc>
+TDynamicVector<T, Alloc> Solve(const TDynamicMatrix<T, Alloc>& A, const TDynamicVector<T, Alloc>& b);
+template<typename T, typename Alloc>
+TDynamicMatrix<T, Alloc> Solve(const TDynamicMatrix<T, Alloc>& A, const TDynamicMatrix<T, Alloc>& B);
+// A или b - выражение (вычисляется во временный контейнер)
+template<typename M, typename B, typename = typename std::enable_if<std::disjunction<TIsExprNode<M>, TIsExprNode<B>>::value>::type>
+inline auto Solve(const M& A, const B& b) -> decltype(Solve(ExprEval(A), ExprEval(b)))
 {
-  if (sz > MAX_MATRIX_SIZE)
+  return Solve(ExprEval(A), ExprEval(b));
+}
+
+template<typename T, typename A>
+inline size_t TDynamicMatrix<T, A>::CheckSize(size_t s)
+{
+  if (s > MAX_MATRIX_SIZE)
     throw out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
-  for (size_t i = 0; i < sz; i++)
-    pMem[i] = TDynamicVector<T>(sz, val);
+  return s;
 }
 
-template<typename T>
-inline void TDynamicMatrix<T>::Transpose()
+template<typename T, typename A>
+inline TDynamicMatrix<T, A>::TDynamicMatrix(size_t s, const T& val, const A& alloc) : TDynamicVector<T, A>(CheckSize(s) * s, val, alloc), sz(s)
 {
-  TDynamicMatrix<T> tmp(*this);
-  for (size_t i = 0; i < sz; i++)
-    for (size_t j = 0; j < sz; j++)
-      (this->operator[](i))[j] = tmp[j][i];
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::Cofactor(size_t i, size_t j) const
+template<typename T, typename A>
+inline TDynamicMatrix<T, A>::TDynamicMatrix(size_t s, TUninitialized, const A& alloc) : TDynamicVector<T, A>(CheckSize(s) * s, TUninitialized(), alloc), sz(s)
 {
+}
+
+template<typename T, typename A>
+template<typename E, typename>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator=(const TExpr<E>& e)
+{
+  this->AssignExpr(e.self(), "matrix.expr_assign");
+  sz = e.self().dim();
+  return *this;
+}
+
+template<typename T, typename A>
+inline TRowView<T, A> TDynamicMatrix<T, A>::at(size_t ind)
+{
+  if (pMem == nullptr) throw "pMem is nullptr";
+  if (ind >= sz) throw out_of_range("index is out of range");
+  return this->operator[](ind);
+}
+
+template<typename T, typename A>
+inline TRowView<const T, A> TDynamicMatrix<T, A>::at(size_t ind) const
+{
+  if (pMem == nullptr) throw "pMem is nullptr";
+  if (ind >= sz) throw out_of_range("index is out of range");
+  return this->operator[](ind);
+}
+
+template<typename T, typename A>
+inline void TDynamicMatrix<T, A>::Transpose()
+{
+  TransposeInPlace(pMem, sz);
+}
+
+template<typename T, typename A>
+inline void TDynamicMatrix<T, A>::Transposed(TDynamicMatrix& dst) const
+{
+  if (sz != dst.sz) throw "Sizes are not equal";
+  if (&dst == this)
+    dst.Transpose();
+  else
+    TransposeInto(pMem, dst.pMem, sz, sz);
+}
+
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TDynamicMatrix<T, A>::Cofactor(size_t i, size_t j) const
+{
+  TAllocSite site("matrix.cofactor");
   (this->at(i)).at(j);
   if (sz == 1)
     throw "Can't have cofactor matrix from matrix with size 1";
-  TDynamicMatrix<T> tmp(sz - 1);
+  TDynamicMatrix<T, A> tmp(sz - 1, TUninitialized(), get_allocator());
 
   size_t tmp1 = 0, tmp2 = 0;
   for (size_t k = 0; k < sz - 1; k++)
@@ -111,149 +210,167 @@ inline TDynamicMatrix<T> TDynamicMatrix<T>::Cofactor(size_t i, size_t j) const
   return tmp;
 }
 
-template<typename T>
-inline T TDynamicMatrix<T>::Det() const
+template<typename T, typename A>
+inline T TDynamicMatrix<T, A>::Det() const
 {
-  if (sz == 1)
-    return (this->operator[](0))[0];
-  else if (sz == 2)
-    return ((this->operator[](0))[0] * (this->operator[](1))[1] - (this->operator[](1))[0] * (this->operator[](0))[1]);
-  else
-  {
-    T d = 0;
-    bool posSign = true;
-    for (size_t k = 0; k < sz; k++)
-    {
-      T temp = (this->operator[](k))[0] * this->Minor(k, 0);
-      if (posSign)
-        d = d + temp;
-      else
-        d = d - temp;
-      posSign = !posSign;
-    }
-    return d;
-  }
+  TAllocSite site("matrix.det");
+  TDynamicVector<T, A> lu(*this);
+  int sign = LUFactor(&lu[0], sz, nullptr);
+  return LUDet(&lu[0], sz, sign);
 }
 
-template<typename T>
-inline T TDynamicMatrix<T>::Minor(size_t i, size_t j) const
+template<typename T, typename A>
+inline T TDynamicMatrix<T, A>::Minor(size_t i, size_t j) const
 {
-  TDynamicMatrix<T> tmp = this->Cofactor(i, j);
+  TDynamicMatrix<T, A> tmp = this->Cofactor(i, j);
   return tmp.Det();
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::Invertible() const
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TDynamicMatrix<T, A>::Invertible() const
 {
-  T d = this->Det();
-  if (d == 0)
+  TAllocSite site("matrix.invertible");
+  TDynamicVector<T, A> lu(*this);
+  TDynamicVector<size_t> perm(sz);
+  if (LUFactor(&lu[0], sz, &perm[0]) == 0)
     throw "Can't have inverible matrix with det = 0.";
-  if (sz == 1)
-  {
-    TDynamicMatrix<T> tmp(*this);
-    return (tmp / d);
-  }
-  TDynamicMatrix<T> tmp(sz);
-  bool posSign = true;
+  TDynamicMatrix<T, A> e(sz, T(), get_allocator()), tmp(sz, TUninitialized(), get_allocator());
   for (size_t i = 0; i < sz; i++)
-    for (size_t j = 0; j < sz; j++)
-    {
-      tmp[i][j] = this->Minor(i, j);
-      if (!posSign)
-        tmp[i][j] = -tmp[i][j];
-      posSign = !posSign;
-    }
-  tmp.Transpose();
-  return (tmp / d);
+    e[i][i] = 1;
+  LUSolve(&lu[0], sz, &perm[0], e.pMem, tmp.pMem, sz);
+  return tmp;
 }
 
-template<typename T>
-inline bool TDynamicMatrix<T>::operator==(const TDynamicMatrix& m) const noexcept
+template<typename T, typename A>
+inline bool TDynamicMatrix<T, A>::operator==(const TDynamicMatrix& m) const noexcept
 {
-  return this->TDynamicVector<TDynamicVector<T>>::operator==(m);
+  if (sz != m.sz)
+    return false;
+  return this->TDynamicVector<T, A>::operator==(m);
 }
 
-template<typename T>
-inline bool TDynamicMatrix<T>::operator!=(const TDynamicMatrix& m) const noexcept
+template<typename T, typename A>
+inline bool TDynamicMatrix<T, A>::operator!=(const TDynamicMatrix& m) const noexcept
 {
   return !(this->operator==(m));
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator*(const T& val)
+template<typename T, typename A>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator*=(const T& val)
 {
-  TDynamicMatrix<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) * val;
-  return tmp;
+  return *this = *this * val;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator/(const T& val)
+template<typename T, typename A>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator/=(const T& val)
 {
-  TDynamicMatrix<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) / val;
-  return tmp;
+  return *this = *this / val;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator-(void)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator+=(const X& m)
 {
-  TDynamicMatrix<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = -(this->operator[](i));
-  return tmp;
+  return *this = *this + m;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicMatrix<T>::operator*(const TDynamicVector<T>& v)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator-=(const X& m)
 {
-  if (sz != v.size()) throw "Sizes are not equal";
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) * v;
-  return tmp;
+  return *this = *this - m;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator+(const TDynamicMatrix& m)
+// Произведение вычисляется в рабочий буфер потока (TGemmWorkspace)
+// и копируется на место, поэтому m может совпадать с *this
+template<typename T, typename A>
+inline TDynamicMatrix<T, A>& TDynamicMatrix<T, A>::operator*=(const TDynamicMatrix& m)
 {
+  TAllocSite site("matrix.mul_assign");
   if (sz != m.sz) throw "Sizes are not equal";
-  TDynamicMatrix<T> tmp(sz);
+  const size_t n = sz * sz;
+  T* c = TGemmWorkspace<T>::Local().Result(n);
+  Gemm(sz, sz, sz, pMem, sz, m.pMem, sz, c, sz, false);
+  std::copy(c, c + n, pMem);
+  return *this;
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A> TDynamicMatrix<T, A>::operator*(const TDynamicVector<T, A>& v) const
+{
+  TAllocSite site("matrix.mul_vector");
+  if (sz != v.size()) throw "Sizes are not equal";
+  TDynamicVector<T, A> tmp(sz, TUninitialized(), get_allocator());
+  TProfileScope profile("matrix.mul_vector");
+  StatsCount(2 * uint64_t(sz) * sz, (uint64_t(sz) * sz + sz) * sizeof(T), uint64_t(sz) * sizeof(T));
   for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) + m[i];
+  {
+    const T* row = pMem + i * sz;
+    if constexpr (TSimdSupported<T>::value)
+      tmp[i] = SimdKernels<T>().dot(row, &v[0], sz);
+    else
+    {
+      T s = T();
+      for (size_t j = 0; j < sz; j++)
+        s = s + row[j] * v[j];
+      tmp[i] = s;
+    }
+  }
   return tmp;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator-(const TDynamicMatrix& m)
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TDynamicMatrix<T, A>::operator*(const TDynamicMatrix& m) const
 {
+  TAllocSite site("matrix.mul_matrix");
   if (sz != m.sz) throw "Sizes are not equal";
-  TDynamicMatrix<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) - m[i];
+  TDynamicMatrix<T, A> tmp(sz, TUninitialized(), get_allocator());
+  Gemm(sz, sz, sz, pMem, sz, m.pMem, sz, tmp.pMem, sz, false);
   return tmp;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator*(const TDynamicMatrix& m)
+template<typename T, typename A>
+inline TDynamicMatrix<T, A> TDynamicMatrix<T, A>::operator/(const TDynamicMatrix& m) const
 {
+  TAllocSite site("matrix.div");
   if (sz != m.sz) throw "Sizes are not equal";
-  TDynamicMatrix<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    for (size_t j = 0; j < sz; j++)
-      for (size_t k = 0; k < sz; k++)
-        tmp[i][j] = tmp[i][j] + (this->operator[](i))[k] * m[k][j];
+  // X * m = A  <=>  m^T * X^T = A^T
+  TDynamicMatrix<T, A> mt(sz, TUninitialized(), get_allocator()), at(sz, TUninitialized(), get_allocator());
+  m.Transposed(mt);
+  Transposed(at);
+  TDynamicMatrix<T, A> tmp = Solve(mt, at);
+  tmp.Transpose();
   return tmp;
 }
 
-template<typename T>
-inline TDynamicMatrix<T> TDynamicMatrix<T>::operator/(const TDynamicMatrix& m)
+template<typename T, typename Alloc>
+inline TDynamicVector<T, Alloc> Solve(const TDynamicMatrix<T, Alloc>& A, const TDynamicVector<T, Alloc>& b)
 {
-  if (sz != m.sz) throw "Sizes are not equal";
-  TDynamicMatrix<T> tmp = m.Invertible();
-  return ((*this) * tmp);
+  TAllocSite site("matrix.solve_vector");
+  const size_t n = A.size();
+  if (n != b.size()) throw "Sizes are not equal";
+  TDynamicVector<T, Alloc> lu(&A[0][0], n * n, A.get_allocator());
+  TDynamicVector<size_t> perm(n);
+  if (LUFactor(&lu[0], n, &perm[0]) == 0)
+    throw "Can't solve system with singular matrix.";
+  TDynamicVector<T, Alloc> x(n, TUninitialized(), A.get_allocator());
+  LUSolve(&lu[0], n, &perm[0], &b[0], &x[0], 1);
+  return x;
+}
+
+template<typename T, typename Alloc>
+inline TDynamicMatrix<T, Alloc> Solve(const TDynamicMatrix<T, Alloc>& A, const TDynamicMatrix<T, Alloc>& B)
+{
+  TAllocSite site("matrix.solve_matrix");
+  const size_t n = A.size();
+  if (n != B.size()) throw "Sizes are not equal";
+  TDynamicVector<T, Alloc> lu(&A[0][0], n * n, A.get_allocator());
+  TDynamicVector<size_t> perm(n);
+  if (LUFactor(&lu[0], n, &perm[0]) == 0)
+    throw "Can't solve system with singular matrix.";
+  TDynamicMatrix<T, Alloc> X(n, TUninitialized(), A.get_allocator());
+  LUSolve(&lu[0], n, &perm[0], &B[0][0], &X[0][0], n);
+  return X;
 }
 
 #endif
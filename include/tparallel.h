@@ -0,0 +1,64 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Пул потоков библиотеки для параллельных ядер
+
+#ifndef __TParallel_H__
+#define __TParallel_H__
+
+#include <cstddef>
+#include <functional>
+
+// Пул создается при первом обращении и живет до конца программы;
+// по умолчанию в нем столько потоков, сколько ядер у процессора
+// (вызывающий поток считается одним из них).
+// Работа распределяется с перехватом (work stealing): у каждого потока
+// своя очередь порций, поток делит свою порцию пополам, пока она больше
+// зерна, и откладывает вторые половины в очередь, а освободившиеся потоки
+// забирают отложенные порции из чужих очередей без блокировок
+
+// Число потоков, на которых выполняются параллельные ядра
+size_t ParallelThreadCount();
+// Изменение числа потоков (0 - по числу ядер); pin - привязать рабочие
+// потоки пула к ядрам 1..n-1 (там, где это поддерживается), привязка
+// вызывающего потока не меняется. Возвращает новое число потоков
+size_t ParallelSetThreadCount(size_t n, bool pin = false);
+
+// Вызов f(begin, end) для порций [begin, end), покрывающих [0, n),
+// порции не меньше grain (кроме последней). Возвращается, когда выполнены
+// все вызовы. Вложенные вызовы из потоков пула выполняются тем же пулом;
+// если пул занят заданием другого потока, вызов выполняется
+// последовательно в вызывающем потоке. Если f выбросила исключение,
+// оставшиеся порции пропускаются, а первое исключение выбрасывается
+// в вызывающем потоке после завершения всех порций
+void ParallelRange(size_t n, size_t grain, const std::function<void(size_t, size_t)>& f);
+// Вызов f(i) для всех i из [0, n), каждый номер - отдельная порция
+void ParallelFor(size_t n, const std::function<void(size_t)>& f);
+
+// Меньше PARALLEL_MIN_WORK элементарных операций на порцию
+// не окупают передачу порции другому потоку
+const size_t PARALLEL_MIN_WORK = 1 << 15;
+
+// Зерно для n элементов стоимостью cost операций каждый:
+// около четырех порций на поток, но не меньше PARALLEL_MIN_WORK операций
+size_t ParallelGrain(size_t n, size_t cost = 1);
+
+// f(begin, end) для порций [0, n): маленькие задачи выполняются сразу,
+// без обращения к пулу
+template<typename F>
+inline void ParallelChunks(size_t n, size_t cost, F&& f)
+{
+  if (n < 2 || double(n) * cost < 2.0 * PARALLEL_MIN_WORK)
+  {
+    f(size_t(0), n);
+    return;
+  }
+  const size_t grain = ParallelGrain(n, cost);
+  if (grain >= n)
+    f(size_t(0), n);
+  else
+    ParallelRange(n, grain, f);
+}
+
+#endif
@@ -0,0 +1,88 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Профилирование ядер аппаратными счетчиками (Linux perf_event)
+
+#ifndef __TProfile_H__
+#define __TProfile_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Области профилирования (TProfileScope) отмечают ядра библиотеки:
+// gemm, lu.factor, lu.solve, transpose, matrix.mul_vector, vector.dot,
+// expr.assign. Области есть в коде только при сборке с MP2_PROFILE
+// (cmake -DMP2_PROFILE=ON), без него TProfileScope пустой.
+// Сбор включается во время выполнения (ProfileSetEnabled): для каждой
+// области накапливаются число вызовов, время и, если ядро ОС разрешает
+// perf_event_open, аппаратные счетчики (такты, инструкции, промахи L1D
+// и последнего уровня кэша, ошибки предсказания переходов).
+// Если доступа нет (perf_event_paranoid, контейнер, не Linux), счетчики
+// остаются нулевыми, а вызовы и время собираются как обычно.
+// Счетчики считают поток, вызвавший ядро: работа потоков пула в них не
+// попадает, поэтому для точных значений - ParallelSetThreadCount(1).
+// Вложенные области учитываются включительно
+
+// Аппаратные события
+enum TProfileEvent
+{
+  PROFILE_CYCLES,
+  PROFILE_INSTRUCTIONS,
+  PROFILE_L1D_MISSES,
+  PROFILE_LLC_MISSES,
+  PROFILE_BRANCH_MISSES,
+  PROFILE_EVENTS
+};
+
+// Итог по одной области
+struct TProfileRecord
+{
+  std::string name;
+  uint64_t calls = 0;
+  uint64_t ns = 0;
+  uint64_t events[PROFILE_EVENTS] = {};
+};
+
+// Включение сбора; возвращает, доступны ли аппаратные счетчики
+bool ProfileSetEnabled(bool enable);
+bool ProfileEnabled();
+// Доступно ли событие (проверяется при первом включении сбора)
+bool ProfileEventAvailable(TProfileEvent e);
+const char* ProfileEventName(TProfileEvent e);
+
+// Итоги по областям (в порядке первого вызова) и их сброс
+std::vector<TProfileRecord> ProfileResults();
+void ProfileReset();
+// Таблица итогов: недоступные события выводятся как n/a
+void ProfilePrint(std::ostream& os);
+
+#ifdef MP2_PROFILE
+
+// Область от создания до уничтожения объекта; name - строковый литерал
+class TProfileScope
+{
+  const char* name;
+  bool active;
+  uint64_t start[PROFILE_EVENTS + 1];
+public:
+  explicit TProfileScope(const char* _name);
+  ~TProfileScope();
+  TProfileScope(const TProfileScope&) = delete;
+  TProfileScope& operator=(const TProfileScope&) = delete;
+};
+
+#else
+
+class TProfileScope
+{
+public:
+  explicit TProfileScope(const char*) noexcept {}
+};
+
+#endif
+
+#endif
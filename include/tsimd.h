@@ -0,0 +1,61 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Векторные (SIMD) ядра поэлементных операций с выбором набора инструкций во время выполнения
+
+#ifndef __TSimd_H__
+#define __TSimd_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Наборы ядер, от наименее к наиболее мощному
+enum TSimdKernelSet
+{
+  SIMD_SCALAR,
+  SIMD_SSE2,
+  SIMD_AVX2,
+  SIMD_AVX512
+};
+
+// Таблица ядер для одного типа элементов;
+// r может совпадать с a или b
+template<typename T>
+struct TSimdKernels
+{
+  void (*add)(const T* a, const T* b, T* r, size_t n);
+  void (*sub)(const T* a, const T* b, T* r, size_t n);
+  void (*addScalar)(const T* a, T val, T* r, size_t n);
+  void (*subScalar)(const T* a, T val, T* r, size_t n);
+  void (*mulScalar)(const T* a, T val, T* r, size_t n);
+  void (*divScalar)(const T* a, T val, T* r, size_t n);
+  void (*neg)(const T* a, T* r, size_t n);
+  T (*dot)(const T* a, const T* b, size_t n);
+};
+
+// Типы, для которых есть векторные ядра
+template<typename T> struct TSimdSupported : std::false_type {};
+template<> struct TSimdSupported<float> : std::true_type {};
+template<> struct TSimdSupported<double> : std::true_type {};
+template<> struct TSimdSupported<int32_t> : std::true_type {};
+template<> struct TSimdSupported<int64_t> : std::true_type {};
+
+// Ядра выбранного набора (определены в src/tsimd.cpp)
+template<typename T> const TSimdKernels<T>& SimdKernels();
+template<> const TSimdKernels<float>& SimdKernels<float>();
+template<> const TSimdKernels<double>& SimdKernels<double>();
+template<> const TSimdKernels<int32_t>& SimdKernels<int32_t>();
+template<> const TSimdKernels<int64_t>& SimdKernels<int64_t>();
+
+// Набор, выбранный по CPUID при запуске (или позже через SimdSelectKernelSet)
+TSimdKernelSet SimdKernelSet();
+const char* SimdKernelSetName();
+// Самый мощный набор, поддерживаемый процессором
+TSimdKernelSet SimdMaxKernelSet();
+// Ограничение набора сверху (например, для сравнения результатов);
+// запросы выше SimdMaxKernelSet() понижаются до него. Возвращает выбранный набор
+TSimdKernelSet SimdSelectKernelSet(TSimdKernelSet s);
+
+#endif
@@ -0,0 +1,95 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Счетчики операций: арифметика, обмен с памятью и выделения памяти
+
+#ifndef __TStats_H__
+#define __TStats_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Счетчики включаются при сборке с MP2_STATS (cmake -DMP2_STATS=ON);
+// без него функции учета пустые и компилятор их удаляет.
+// Ядра учитывают модель своей работы (как bench/): flops - арифметические
+// операции, bytesRead/bytesWritten - обязательное чтение операндов и запись
+// результата, allocs/bytesAllocated - выделения памяти контейнерами.
+// Учет ведется в счетчиках потока без синхронизации; счетчики порций,
+// выполненных потоками пула, переносятся в поток, запустивший
+// параллельное задание (tparallel.cpp), когда задание завершается,
+// поэтому работа пула относится к вызвавшему операцию потоку
+struct TOpStats
+{
+  uint64_t flops = 0;
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t allocs = 0;
+  uint64_t bytesAllocated = 0;
+};
+
+inline TOpStats operator+(const TOpStats& a, const TOpStats& b) noexcept
+{
+  TOpStats r;
+  r.flops = a.flops + b.flops;
+  r.bytesRead = a.bytesRead + b.bytesRead;
+  r.bytesWritten = a.bytesWritten + b.bytesWritten;
+  r.allocs = a.allocs + b.allocs;
+  r.bytesAllocated = a.bytesAllocated + b.bytesAllocated;
+  return r;
+}
+
+// Разность снимков: счетчики операций между двумя вызовами StatsGet
+inline TOpStats operator-(const TOpStats& a, const TOpStats& b) noexcept
+{
+  TOpStats r;
+  r.flops = a.flops - b.flops;
+  r.bytesRead = a.bytesRead - b.bytesRead;
+  r.bytesWritten = a.bytesWritten - b.bytesWritten;
+  r.allocs = a.allocs - b.allocs;
+  r.bytesAllocated = a.bytesAllocated - b.bytesAllocated;
+  return r;
+}
+
+#ifdef MP2_STATS
+
+constexpr bool StatsEnabled() noexcept { return true; }
+
+inline TOpStats& StatsLocal() noexcept
+{
+  static thread_local TOpStats stats;
+  return stats;
+}
+
+inline void StatsCount(uint64_t flops, uint64_t bytesRead, uint64_t bytesWritten) noexcept
+{
+  TOpStats& s = StatsLocal();
+  s.flops += flops;
+  s.bytesRead += bytesRead;
+  s.bytesWritten += bytesWritten;
+}
+
+inline void StatsAlloc(uint64_t bytes) noexcept
+{
+  TOpStats& s = StatsLocal();
+  s.allocs++;
+  s.bytesAllocated += bytes;
+}
+
+// Счетчики текущего потока
+inline TOpStats StatsGet() noexcept { return StatsLocal(); }
+inline void StatsReset() noexcept { StatsLocal() = TOpStats(); }
+
+#else
+
+constexpr bool StatsEnabled() noexcept { return false; }
+
+inline void StatsCount(uint64_t, uint64_t, uint64_t) noexcept {}
+inline void StatsAlloc(uint64_t) noexcept {}
+
+inline TOpStats StatsGet() noexcept { return TOpStats(); }
+inline void StatsReset() noexcept {}
+
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+//
+//
+// Транспонирование матриц рекурсивным делением на блоки (cache-oblivious)
+
+#ifndef __TTranspose_H__
+#define __TTranspose_H__
+
+#include "tparallel.h"
+#include "tstats.h"
+#include "tprofile.h"
+#include <cstddef>
+#include <utility>
+
+using namespace std;
+
+// Блоки делятся пополам по большей стороне, пока обе стороны не станут
+// не больше TRANSPOSE_LEAF; такие блоки (и парные им) помещаются в L1
+// при любом размере кэша, поэтому размер блока не надо подбирать
+const size_t TRANSPOSE_LEAF = 32;
+// Ширина полосы строк, которая отдается одному потоку
+const size_t TRANSPOSE_STRIP = 256;
+
+// Обмен блока a (m x n) с транспонированным блоком b (n x m):
+// a[i][j] <-> b[j][i], обе матрицы с шагом строк ld
+template<typename T>
+inline void TransposeSwap(T* a, T* b, size_t m, size_t n, size_t ld)
+{
+  if (m <= TRANSPOSE_LEAF && n <= TRANSPOSE_LEAF)
+  {
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++)
+        std::swap(a[i * ld + j], b[j * ld + i]);
+  }
+  else if (m >= n)
+  {
+    const size_t h = m / 2;
+    TransposeSwap(a, b, h, n, ld);
+    TransposeSwap(a + h * ld, b + h, m - h, n, ld);
+  }
+  else
+  {
+    const size_t h = n / 2;
+    TransposeSwap(a, b, m, h, ld);
+    TransposeSwap(a + h, b + h * ld, m, n - h, ld);
+  }
+}
+
+// Транспонирование на месте квадратного блока n x n с шагом строк ld:
+// блоки на диагонали транспонируются рекурсивно, внедиагональные - обмениваются
+template<typename T>
+inline void TransposeSquare(T* a, size_t n, size_t ld)
+{
+  if (n <= TRANSPOSE_LEAF)
+  {
+    for (size_t i = 0; i < n; i++)
+      for (size_t j = i + 1; j < n; j++)
+        std::swap(a[i * ld + j], a[j * ld + i]);
+    return;
+  }
+  const size_t h = n / 2;
+  TransposeSquare(a, h, ld);
+  TransposeSquare(a + h * ld + h, n - h, ld);
+  TransposeSwap(a + h, a + h * ld, h, n - h, ld);
+}
+
+// b = a^T, где a - m x n с шагом строк lda, b - n x m с шагом ldb
+template<typename T>
+inline void TransposeCopy(const T* a, size_t lda, T* b, size_t ldb, size_t m, size_t n)
+{
+  if (m <= TRANSPOSE_LEAF && n <= TRANSPOSE_LEAF)
+  {
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++)
+        b[j * ldb + i] = a[i * lda + j];
+  }
+  else if (m >= n)
+  {
+    const size_t h = m / 2;
+    TransposeCopy(a, lda, b, ldb, h, n);
+    TransposeCopy(a + h * lda, lda, b + h, ldb, m - h, n);
+  }
+  else
+  {
+    const size_t h = n / 2;
+    TransposeCopy(a, lda, b, ldb, m, h);
+    TransposeCopy(a + h, lda, b + h * ldb, ldb, m, n - h);
+  }
+}
+
+// Транспонирование на месте матрицы n x n (без дополнительной памяти):
+// полоса строк [i0, i1) транспонирует свой диагональный блок и обменивает
+// остаток строк с соответствующей полосой столбцов; полосы независимы
+template<typename T>
+inline void TransposeInPlace(T* a, size_t n)
+{
+  TProfileScope profile("transpose");
+  StatsCount(0, uint64_t(n) * n * sizeof(T), uint64_t(n) * n * sizeof(T));
+  const size_t strips = (n + TRANSPOSE_STRIP - 1) / TRANSPOSE_STRIP;
+  ParallelChunks(strips, TRANSPOSE_STRIP * n, [a, n](size_t begin, size_t end)
+  {
+    for (size_t s = begin; s < end; s++)
+    {
+      const size_t i0 = s * TRANSPOSE_STRIP;
+      const size_t i1 = i0 + TRANSPOSE_STRIP < n ? i0 + TRANSPOSE_STRIP : n;
+      TransposeSquare(a + i0 * n + i0, i1 - i0, n);
+      TransposeSwap(a + i0 * n + i1, a + i1 * n + i0, i1 - i0, n - i1, n);
+    }
+  });
+}
+
+// b = a^T для a размера m x n (построчно, без промежутков), полосами строк a
+template<typename T>
+inline void TransposeInto(const T* a, T* b, size_t m, size_t n)
+{
+  TProfileScope profile("transpose");
+  StatsCount(0, uint64_t(m) * n * sizeof(T), uint64_t(m) * n * sizeof(T));
+  const size_t strips = (m + TRANSPOSE_STRIP - 1) / TRANSPOSE_STRIP;
+  ParallelChunks(strips, TRANSPOSE_STRIP * n, [a, b, m, n](size_t begin, size_t end)
+  {
+    for (size_t s = begin; s < end; s++)
+    {
+      const size_t i0 = s * TRANSPOSE_STRIP;
+      const size_t i1 = i0 + TRANSPOSE_STRIP < m ? i0 + TRANSPOSE_STRIP : m;
+      TransposeCopy(a + i0 * n, n, b + i0, m, i1 - i0, n);
+    }
+  });
+}
+
+#endif
@@ -8,6 +8,14 @@
 #define __TDynamicVector_H__
 
 #include <iostream>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include "talloc.h"
+#include "tsimd.h"
+#include "tstats.h"
+#include "talloctrace.h"
+#include "texpr.h"
 
 using namespace std;
 
@@ -15,23 +23,59 @@ const size_t MAX_VECTOR_SIZE = 100000000;
 
 //   - 
 //     
-template<typename T>
-class TDynamicVector
+// (   A, . talloc.h)
+template<typename T, typename A>
+class TDynamicVector : private TAllocHolder<A>
 {
+  static_assert(std::is_same<typename A::value_type, T>::value, "Allocator value_type should be T");
+  typedef std::allocator_traits<A> TAllocTraits;
+
 protected:
   size_t sz;
   T* pMem;
+
+  //    ; construct(p)   n
+  //  (   ) ,  ,  ;
+  // site -        (talloctrace.h)
+  template<typename F>
+  T* Allocate(size_t n, F construct, const char* site);
+  void Deallocate(T* p, size_t n) noexcept;
+
+  //     (  );
+  // site -    (  )
+  template<typename E>
+  TDynamicVector(const TExpr<E>& e, TExprFlat, const char* site = "expr.construct");
+  template<typename E>
+  void AssignExpr(const E& e, const char* site = "expr.assign");
+
+  friend struct TExprAccess;
 public:
+  typedef T value_type;
+  typedef A allocator_type;
+
   //TDynamicVector(size_t size = 1);
-  TDynamicVector(size_t size = 1, const T& val = T());
-  TDynamicVector(const T* arr, size_t s);
+  TDynamicVector(size_t size = 1, const T& val = T(), const A& alloc = A());
+  //      (  ,
+  //    ),    
+  TDynamicVector(size_t size, TUninitialized, const A& alloc = A());
+  TDynamicVector(const T* arr, size_t s, const A& alloc = A());
   TDynamicVector(const TDynamicVector& v);
+  TDynamicVector(const TDynamicVector& v, const A& alloc);
   TDynamicVector(TDynamicVector&& v) noexcept;
   ~TDynamicVector();
   TDynamicVector& operator=(const TDynamicVector& v);
-  TDynamicVector& operator=(TDynamicVector&& v) noexcept;
+  //       
+  //     
+  TDynamicVector& operator=(TDynamicVector&& v)
+    noexcept(TAllocTraits::propagate_on_container_move_assignment::value || TAllocTraits::is_always_equal::value);
+  //    (texpr.h)   
+  template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDynamicVector>::value>::type>
+  TDynamicVector(const TExpr<E>& e) : TDynamicVector(e, TExprFlat()) {}
+  template<typename E, typename = typename std::enable_if<std::is_same<typename E::result_type, TDynamicVector>::value>::type>
+  TDynamicVector& operator=(const TExpr<E>& e) { AssignExpr(e.self()); return *this; }
 
   size_t size() const noexcept { return sz; }
+  A get_allocator() const noexcept { return this->Alloc(); }
 
   // 
   T& operator[](size_t ind);
@@ -44,20 +88,29 @@ public:
   bool operator==(const TDynamicVector& v) const noexcept;
   bool operator!=(const TDynamicVector& v) const noexcept;
 
-  //  
-  TDynamicVector operator+(const T& val);
-  TDynamicVector operator-(const T& val);
-  TDynamicVector operator*(const T& val);
-  TDynamicVector operator/(const T& val);
-  TDynamicVector operator-(void);
+  //     -   (texpr.h)
 
-  //  
-  TDynamicVector operator+(const TDynamicVector& v);
-  TDynamicVector operator-(const TDynamicVector& v);
-  T operator*(const TDynamicVector& v);
+  //     (  )
+  TDynamicVector& operator+=(const T& val);
+  TDynamicVector& operator-=(const T& val);
+  TDynamicVector& operator*=(const T& val);
+  TDynamicVector& operator/=(const T& val);
+  template<typename X, typename = typename std::enable_if<TExprCompatible<TDynamicVector, X>::value>::type>
+  TDynamicVector& operator+=(const X& v);
+  template<typename X, typename = typename std::enable_if<TExprCompatible<TDynamicVector, X>::value>::type>
+  TDynamicVector& operator-=(const X& v);
 
+  //     propagate_on_container_swap,
+  //     
   friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
   {
+    if constexpr (TAllocTraits::propagate_on_container_swap::value)
+    {
+      using std::swap;
+      swap(lhs.Alloc(), rhs.Alloc());
+    }
+    else
+      assert(lhs.Alloc() == rhs.Alloc() && "swap of containers with unequal allocators");
     std::swap(lhs.sz, rhs.sz);
     std::swap(lhs.pMem, rhs.pMem);
   }
@@ -78,6 +131,39 @@ public:
   }
 };
 
+template<typename T, typename A>
+struct TIsExprContainer<TDynamicVector<T, A>> : std::true_type {};
+
+template<typename T, typename A>
+template<typename F>
+inline T* TDynamicVector<T, A>::Allocate(size_t n, F construct, const char* site)
+{
+  A& alloc = this->Alloc();
+  T* p = TAllocTraits::allocate(alloc, n);
+  StatsAlloc(uint64_t(n) * sizeof(T));
+  try
+  {
+    construct(p);
+  }
+  catch (...)
+  {
+    TAllocTraits::deallocate(alloc, p, n);
+    throw;
+  }
+  AllocTraceAlloc(p, n * sizeof(T), site);
+  return p;
+}
+
+template<typename T, typename A>
+inline void TDynamicVector<T, A>::Deallocate(T* p, size_t n) noexcept
+{
+  if (p == nullptr)
+    return;
+  AllocTraceFree(p);
+  std::destroy_n(p, n);
+  TAllocTraits::deallocate(this->Alloc(), p, n);
+}
+
 //template<typename T>
 //inline TDynamicVector<T>::TDynamicVector(size_t size) : sz(size)
 //{
@@ -88,30 +174,45 @@ public:
 //  pMem = new T[sz]();// {}; //   T ..   
 //}
 
-template<typename T>
-inline TDynamicVector<T>::TDynamicVector(size_t size, const T& val) : sz(size)
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(size_t size, const T& val, const A& alloc) : TAllocHolder<A>(alloc), sz(size)
 {
   if (sz == 0)
     throw out_of_range("Size should be greater than zero");
   if (sz > MAX_VECTOR_SIZE)
     throw out_of_range("Vector size should be less than MAX_VECTOR_SIZE");
-  pMem = new T[sz];
-  for (size_t i = 0; i < sz; i++)
-    pMem[i] = val;
+  pMem = Allocate(sz, [&](T* p) { std::uninitialized_fill_n(p, sz, val); }, "vector.ctor");
+  StatsCount(0, 0, uint64_t(sz) * sizeof(T));
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(size_t size, TUninitialized, const A& alloc) : TAllocHolder<A>(alloc), sz(size)
+{
+  if (sz == 0)
+    throw out_of_range("Size should be greater than zero");
+  if (sz > MAX_VECTOR_SIZE)
+    throw out_of_range("Vector size should be less than MAX_VECTOR_SIZE");
+  pMem = Allocate(sz, [&](T* p) { std::uninitialized_default_construct_n(p, sz); }, "vector.ctor_uninit");
 }
 
-template<typename T>
-inline TDynamicVector<T>::TDynamicVector(const T* arr, size_t s) : sz(s)
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(const T* arr, size_t s, const A& alloc) : TAllocHolder<A>(alloc), sz(s)
 {
   assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
   if (sz > MAX_VECTOR_SIZE)
     throw out_of_range("Vector size should be less than MAX_VECTOR_SIZE");
-  pMem = new T[sz];
-  std::copy(arr, arr + sz, pMem);
+  pMem = Allocate(sz, [&](T* p) { std::uninitialized_copy_n(arr, sz, p); }, "vector.ctor_array");
+  StatsCount(0, uint64_t(sz) * sizeof(T), uint64_t(sz) * sizeof(T));
 }
 
-template<typename T>
-inline TDynamicVector<T>::TDynamicVector(const TDynamicVector& v)
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(const TDynamicVector& v)
+  : TDynamicVector(v, TAllocTraits::select_on_container_copy_construction(v.Alloc()))
+{
+}
+
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(const TDynamicVector& v, const A& alloc) : TAllocHolder<A>(alloc)
 {
   if (v.pMem == nullptr)
   {
@@ -121,167 +222,275 @@ inline TDynamicVector<T>::TDynamicVector(const TDynamicVector& v)
   else
   {
     sz = v.sz;
-    pMem = new T[sz];
-    std::copy(v.pMem, v.pMem + sz, pMem);
+    pMem = Allocate(sz, [&](T* p) { std::uninitialized_copy_n(v.pMem, sz, p); }, "vector.copy");
+    StatsCount(0, uint64_t(sz) * sizeof(T), uint64_t(sz) * sizeof(T));
   }
 }
 
-template<typename T>
-inline TDynamicVector<T>::TDynamicVector(TDynamicVector&& v) noexcept
+template<typename T, typename A>
+inline TDynamicVector<T, A>::TDynamicVector(TDynamicVector&& v) noexcept : TAllocHolder<A>(v.Alloc()), sz(v.sz), pMem(v.pMem)
+{
+  v.sz = 0;
+  v.pMem = nullptr;
+}
+
+template<typename T, typename A>
+template<typename E>
+inline TDynamicVector<T, A>::TDynamicVector(const TExpr<E>& e, TExprFlat, const char* site) : TAllocHolder<A>(A(e.self().allocator())), sz(e.self().count())
+{
+  pMem = Allocate(sz, [&](T* p) { ExprConstruct(p, e.self()); }, site);
+}
+
+template<typename T, typename A>
+template<typename E>
+inline void TDynamicVector<T, A>::AssignExpr(const E& e, const char* site)
 {
-  pMem = nullptr;
-  swap(*this, v);
+  const size_t n = e.count();
+  if (sz != n)
+  {
+    //      
+    T* tmp = Allocate(n, [&](T* p) { ExprConstruct(p, e); }, site);
+    Deallocate(pMem, sz);
+    sz = n;
+    pMem = tmp;
+  }
+  else
+    ExprAssign(pMem, e);
 }
 
-template<typename T>
-inline TDynamicVector<T>::~TDynamicVector()
+template<typename T, typename A>
+inline TDynamicVector<T, A>::~TDynamicVector()
 {
-  delete[] pMem;
+  Deallocate(pMem, sz);
   sz = 0;
 }
 
-template<typename T>
-inline TDynamicVector<T>& TDynamicVector<T>::operator=(const TDynamicVector& v)
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator=(const TDynamicVector& v)
 {
   if (this == &v)
     return *this;
+  StatsCount(0, uint64_t(v.sz) * sizeof(T), uint64_t(v.sz) * sizeof(T));
+  if constexpr (TAllocTraits::propagate_on_container_copy_assignment::value)
+  {
+    //   ,   
+    if (!(this->Alloc() == v.Alloc()))
+    {
+      Deallocate(pMem, sz);
+      sz = 0;
+      pMem = nullptr;
+    }
+    this->Alloc() = v.Alloc();
+  }
   if (sz != v.sz)
   {
-    T* tmp = new T[v.sz];
-    delete[] pMem;
+    T* tmp = Allocate(v.sz, [&](T* p) { std::uninitialized_copy_n(v.pMem, v.sz, p); }, "vector.assign");
+    Deallocate(pMem, sz);
     sz = v.sz;
     pMem = tmp;
   }
-  std::copy(v.pMem, v.pMem + sz, pMem);
+  else
+    std::copy(v.pMem, v.pMem + sz, pMem);
   return *this;
 }
 
-template<typename T>
-inline TDynamicVector<T>& TDynamicVector<T>::operator=(TDynamicVector&& v) noexcept
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator=(TDynamicVector&& v)
+  noexcept(TAllocTraits::propagate_on_container_move_assignment::value || TAllocTraits::is_always_equal::value)
 {
-  swap(*this, v);
+  if (this == &v)
+    return *this;
+  if constexpr (!(TAllocTraits::propagate_on_container_move_assignment::value || TAllocTraits::is_always_equal::value))
+  {
+    //      
+    if (!(this->Alloc() == v.Alloc()))
+    {
+      T* tmp = Allocate(v.sz, [&](T* p) { std::uninitialized_move_n(v.pMem, v.sz, p); }, "vector.assign");
+      Deallocate(pMem, sz);
+      sz = v.sz;
+      pMem = tmp;
+      return *this;
+    }
+  }
+  Deallocate(pMem, sz);
+  if constexpr (TAllocTraits::propagate_on_container_move_assignment::value)
+    this->Alloc() = std::move(v.Alloc());
+  sz = v.sz;
+  pMem = v.pMem;
+  v.sz = 0;
   v.pMem = nullptr;
   return *this;
 }
 
-template<typename T>
-inline T& TDynamicVector<T>::operator[](size_t ind)
+template<typename T, typename A>
+inline T& TDynamicVector<T, A>::operator[](size_t ind)
 {
   return pMem[ind];
 }
 
-template<typename T>
-inline const T& TDynamicVector<T>::operator[](size_t ind) const
+template<typename T, typename A>
+inline const T& TDynamicVector<T, A>::operator[](size_t ind) const
 {
   return pMem[ind];
 }
 
-template<typename T>
-inline T& TDynamicVector<T>::at(size_t ind)
+template<typename T, typename A>
+inline T& TDynamicVector<T, A>::at(size_t ind)
 {
   if (pMem == nullptr) throw "pMem is nullptr";
   if (ind >= sz) throw out_of_range("index is out of range");
   return this->operator[](ind);
 }
 
-template<typename T>
-inline const T& TDynamicVector<T>::at(size_t ind) const
+template<typename T, typename A>
+inline const T& TDynamicVector<T, A>::at(size_t ind) const
 {
   if (pMem == nullptr) throw "pMem is nullptr";
   if (ind >= sz) throw out_of_range("index is out of range");
   return this->operator[](ind);
 }
 
-template<typename T>
-inline bool TDynamicVector<T>::operator==(const TDynamicVector& v) const noexcept
+template<typename T, typename A>
+inline bool TDynamicVector<T, A>::operator==(const TDynamicVector& v) const noexcept
 {
   if (v.sz != sz)
     return false;
+  StatsCount(0, 2 * uint64_t(sz) * sizeof(T), 0);
   for (size_t i = 0; i < sz; i++)
     if (this->operator[](i) != v[i])
       return false;
   return true;
 }
 
-template<typename T>
-inline bool TDynamicVector<T>::operator!=(const TDynamicVector& v) const noexcept
+template<typename T, typename A>
+inline bool TDynamicVector<T, A>::operator!=(const TDynamicVector& v) const noexcept
 {
   return !(this->operator==(v));
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator+(const T& val)
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator+=(const T& val)
 {
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) + val;
-  return tmp;
+  return *this = *this + val;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator-(const T& val)
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator-=(const T& val)
 {
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) - val;
-  return tmp;
+  return *this = *this - val;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator*(const T& val)
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator*=(const T& val)
 {
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) * val;
-  return tmp;
+  return *this = *this * val;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator/(const T& val)
+template<typename T, typename A>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator/=(const T& val)
 {
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) / val;
-  return tmp;
+  return *this = *this / val;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator+(const TDynamicVector& v)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator+=(const X& v)
 {
-  if (sz != v.sz) throw "Sizes are not equal";
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) + v[i];
-  return tmp;
+  return *this = *this + v;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator-(const TDynamicVector& v)
+template<typename T, typename A>
+template<typename X, typename>
+inline TDynamicVector<T, A>& TDynamicVector<T, A>::operator-=(const X& v)
 {
-  if (sz != v.sz) throw "Sizes are not equal";
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = this->operator[](i) - v[i];
-  return tmp;
+  return *this = *this - v;
 }
 
-template<typename T>
-inline TDynamicVector<T> TDynamicVector<T>::operator-()
+//   - 
+//     ;
+// A -   ( ,    )
+template<typename T, typename A>
+class TRowView
 {
-  TDynamicVector<T> tmp(sz);
-  for (size_t i = 0; i < sz; i++)
-    tmp[i] = -(this->operator[](i));
-  return tmp;
+  using value_type = typename std::remove_const<T>::type;
+protected:
+  T* pMem;
+  size_t sz;
+public:
+  typedef A allocator_type;
+
+  TRowView(T* p, size_t s) noexcept : pMem(p), sz(s) {}
+  TRowView(const TRowView& r) noexcept = default;
+  template<typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+  TRowView(const TRowView<U, A>& r) noexcept : pMem(r.data()), sz(r.size()) {}
+
+  //   ,    
+  TRowView& operator=(const TRowView& r);
+  template<typename B>
+  TRowView& operator=(const TDynamicVector<value_type, B>& v);
+  template<typename E, typename = typename std::enable_if<std::conjunction<TExprIsVector<typename E::result_type>,
+    std::is_same<typename E::value_type, value_type>>::value>::type>
+  TRowView& operator=(const TExpr<E>& e);
+
+  size_t size() const noexcept { return sz; }
+  T* data() const noexcept { return pMem; }
+
+  // 
+  T& operator[](size_t ind) const { return pMem[ind]; }
+  //   
+  T& at(size_t ind) const;
+
+  operator TDynamicVector<value_type, A>() const { return TDynamicVector<value_type, A>(pMem, sz); }
+
+  // /
+  friend istream& operator>>(istream& istr, TRowView r)
+  {
+    for (size_t i = 0; i < r.sz; i++)
+      istr >> r.pMem[i];
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TRowView& r)
+  {
+    for (size_t i = 0; i < r.sz; i++)
+      ostr << r.pMem[i] << '\t';
+    return ostr;
+  }
+};
+
+template<typename T, typename A>
+inline TRowView<T, A>& TRowView<T, A>::operator=(const TRowView& r)
+{
+  if (sz != r.sz) throw "Sizes are not equal";
+  if (pMem != r.pMem)
+    std::copy(r.pMem, r.pMem + sz, pMem);
+  return *this;
 }
 
-template<typename T>
-inline T TDynamicVector<T>::operator*(const TDynamicVector& v)
+template<typename T, typename A>
+template<typename B>
+inline TRowView<T, A>& TRowView<T, A>::operator=(const TDynamicVector<value_type, B>& v)
 {
-  if (sz != v.sz) throw "Sizes are not equal";
-  T tmp = T();
+  if (sz != v.size()) throw "Sizes are not equal";
   for (size_t i = 0; i < sz; i++)
-    tmp = tmp + this->operator[](i) * v[i];
-  return tmp;
+    pMem[i] = v[i];
+  return *this;
+}
+
+template<typename T, typename A>
+template<typename E, typename>
+inline TRowView<T, A>& TRowView<T, A>::operator=(const TExpr<E>& e)
+{
+  if (sz != e.self().dim()) throw "Sizes are not equal";
+  ExprAssign(pMem, e.self());
+  return *this;
+}
+
+template<typename T, typename A>
+inline T& TRowView<T, A>::at(size_t ind) const
+{
+  if (pMem == nullptr) throw "pMem is nullptr";
+  if (ind >= sz) throw out_of_range("index is out of range");
+  return pMem[ind];
 }
 
 #endif
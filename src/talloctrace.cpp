@@ -0,0 +1,184 @@
+#include "talloctrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+// Состояние не уничтожается: буферы статических контейнеров
+// освобождаются и после печати сводки
+struct TAllocTraceState
+{
+  struct TLive
+  {
+    size_t site;
+    uint64_t bytes;
+    uint64_t t0;
+  };
+
+  std::mutex mutex;
+  std::vector<TAllocSiteStats> sites;
+  std::map<std::string, size_t> index;
+  std::unordered_map<const void*, TLive> live;
+  uint64_t liveBytes = 0;
+  uint64_t peakLiveBytes = 0;
+  bool exitReport = true;
+};
+
+static void AllocTraceExitReport();
+
+static TAllocTraceState& AllocTraceState()
+{
+  static TAllocTraceState* state = []
+  {
+    TAllocTraceState* s = new TAllocTraceState;
+    std::atexit(AllocTraceExitReport);
+    return s;
+  }();
+  return *state;
+}
+
+static void AllocTraceExitReport()
+{
+  TAllocTraceState& s = AllocTraceState();
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    if (!s.exitReport || s.sites.empty())
+      return;
+  }
+  std::cerr << std::endl << "container allocations by call site:" << std::endl;
+  AllocTracePrint(std::cerr);
+}
+
+std::vector<TAllocSiteStats> AllocTraceResults()
+{
+  TAllocTraceState& s = AllocTraceState();
+  std::vector<TAllocSiteStats> res;
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    res = s.sites;
+  }
+  std::stable_sort(res.begin(), res.end(), [](const TAllocSiteStats& a, const TAllocSiteStats& b) { return a.allocs > b.allocs; });
+  return res;
+}
+
+uint64_t AllocTracePeakLiveBytes()
+{
+  TAllocTraceState& s = AllocTraceState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  return s.peakLiveBytes;
+}
+
+void AllocTraceReset()
+{
+  TAllocTraceState& s = AllocTraceState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.sites.clear();
+  s.index.clear();
+  s.live.clear();
+  s.liveBytes = 0;
+  s.peakLiveBytes = 0;
+}
+
+void AllocTraceSetExitReport(bool enable)
+{
+  TAllocTraceState& s = AllocTraceState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  s.exitReport = enable;
+}
+
+void AllocTracePrint(std::ostream& os)
+{
+  const std::vector<TAllocSiteStats> sites = AllocTraceResults();
+  os << std::left << std::setw(26) << "site" << std::right << std::setw(10) << "allocs" << std::setw(10) << "frees"
+    << std::setw(14) << "bytes" << std::setw(12) << "live" << std::setw(12) << "peak live"
+    << std::setw(14) << "avg life us" << std::setw(14) << "max life us" << std::endl;
+  uint64_t allocs = 0, bytes = 0;
+  for (const TAllocSiteStats& r : sites)
+  {
+    allocs += r.allocs;
+    bytes += r.bytes;
+    os << std::left << std::setw(26) << r.site << std::right << std::setw(10) << r.allocs << std::setw(10) << r.frees
+      << std::setw(14) << r.bytes << std::setw(12) << r.liveBytes << std::setw(12) << r.peakLiveBytes
+      << std::fixed << std::setprecision(1)
+      << std::setw(14) << (r.frees ? double(r.lifetimeNs) / double(r.frees) / 1e3 : 0.0)
+      << std::setw(14) << double(r.maxLifetimeNs) / 1e3 << std::defaultfloat << std::endl;
+  }
+  os << std::left << std::setw(26) << "total" << std::right << std::setw(10) << allocs << std::setw(10) << ""
+    << std::setw(14) << bytes << std::setw(12) << "" << std::setw(12) << AllocTracePeakLiveBytes() << std::endl;
+}
+
+#ifdef MP2_ALLOC_TRACE
+
+static thread_local const char* allocSite = nullptr;
+
+static uint64_t AllocTraceNow()
+{
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TAllocSite::TAllocSite(const char* name) noexcept : prev(allocSite)
+{
+  allocSite = name;
+}
+
+TAllocSite::~TAllocSite()
+{
+  allocSite = prev;
+}
+
+void AllocTraceAlloc(const void* p, size_t bytes, const char* fallback) noexcept
+{
+  const char* name = allocSite != nullptr ? allocSite : fallback;
+  const uint64_t t0 = AllocTraceNow();
+  TAllocTraceState& s = AllocTraceState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  try
+  {
+    auto it = s.index.find(name);
+    if (it == s.index.end())
+    {
+      it = s.index.emplace(name, s.sites.size()).first;
+      s.sites.emplace_back();
+      s.sites.back().site = name;
+    }
+    TAllocSiteStats& r = s.sites[it->second];
+    s.live[p] = TAllocTraceState::TLive{ it->second, bytes, t0 };
+    r.allocs++;
+    r.bytes += bytes;
+    r.liveBytes += bytes;
+    r.peakLiveBytes = std::max(r.peakLiveBytes, r.liveBytes);
+    s.liveBytes += bytes;
+    s.peakLiveBytes = std::max(s.peakLiveBytes, s.liveBytes);
+  }
+  catch (...)
+  {
+    // диагностика не должна менять поведение программы: запись теряется
+  }
+}
+
+void AllocTraceFree(const void* p) noexcept
+{
+  const uint64_t t1 = AllocTraceNow();
+  TAllocTraceState& s = AllocTraceState();
+  std::lock_guard<std::mutex> lock(s.mutex);
+  auto it = s.live.find(p);
+  // буфер выделен до AllocTraceReset
+  if (it == s.live.end())
+    return;
+  TAllocSiteStats& r = s.sites[it->second.site];
+  const uint64_t life = t1 - it->second.t0;
+  r.frees++;
+  r.liveBytes -= it->second.bytes;
+  r.lifetimeNs += life;
+  r.maxLifetimeNs = std::max(r.maxLifetimeNs, life);
+  s.liveBytes -= it->second.bytes;
+  s.live.erase(it);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include "tgemm.h"
+
+#include <atomic>
+
+static std::atomic<bool> gemmParallel(true);
+
+bool GemmParallelEnabled()
+{
+  return gemmParallel.load(std::memory_order_relaxed);
+}
+
+void GemmSetParallel(bool enable)
+{
+  gemmParallel.store(enable, std::memory_order_relaxed);
+}
+
+// на меньших размерах выигрыш в умножениях съедают
+// дополнительные проходы по памяти при сложениях блоков
+static std::atomic<bool> gemmStrassen(false);
+static std::atomic<size_t> gemmStrassenCutoff(2048);
+
+bool GemmStrassenEnabled()
+{
+  return gemmStrassen.load(std::memory_order_relaxed);
+}
+
+void GemmSetStrassen(bool enable)
+{
+  gemmStrassen.store(enable, std::memory_order_relaxed);
+}
+
+size_t GemmStrassenCutoff()
+{
+  return gemmStrassenCutoff.load(std::memory_order_relaxed);
+}
+
+// порог меньше 2 не дает разбить матрицу на половины
+void GemmSetStrassenCutoff(size_t cutoff)
+{
+  gemmStrassenCutoff.store(cutoff < 2 ? 2 : cutoff, std::memory_order_relaxed);
+}
@@ -3,4 +3,6 @@
 
 #include "TUTriangleMatrix.h"
 #include "TDTriangleMatrix.h"
-//#include "TBandMatrix.h" // rip
\ No newline at end of file
+#include "TRectMatrix.h"
+#include "TBandMatrix.h"
+#include "TSparseMatrix.h"
\ No newline at end of file
@@ -0,0 +1,356 @@
+#include "tparallel.h"
+#include "tstats.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Задание: функция, зерно и число еще не обработанных элементов.
+// Первое исключение из f запоминается (error пишет поток, установивший
+// failed, до уменьшения pending), остальные порции пропускаются
+struct TParallelJob
+{
+  const std::function<void(size_t, size_t)>* f;
+  size_t grain;
+  std::atomic<size_t> pending;
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+#ifdef MP2_STATS
+  // счетчики (tstats.h) порций, выполненных не в потоке задания
+  TOpStats* owner = &StatsLocal();
+  std::mutex statsMutex;
+  TOpStats stats;
+#endif
+
+  void Rethrow() const
+  {
+    if (error)
+      std::rethrow_exception(error);
+  }
+};
+
+// Очередь Чейза - Лева фиксированной емкости: владелец кладет и берет
+// порции снизу, остальные потоки перехватывают сверху через CAS.
+// Поля ячеек атомарные, поэтому чтение ячейки, которую перехватил
+// другой поток, не является гонкой (прочитанное просто отбрасывается)
+class TWorkDeque
+{
+public:
+  struct TTask
+  {
+    TParallelJob* job;
+    size_t begin, end;
+  };
+
+private:
+  static constexpr long long CAPACITY = 256;
+
+  struct TSlot
+  {
+    std::atomic<TParallelJob*> job{nullptr};
+    std::atomic<size_t> begin{0}, end{0};
+  };
+
+  alignas(64) std::atomic<long long> top{0};
+  alignas(64) std::atomic<long long> bottom{0};
+  TSlot slots[CAPACITY];
+
+  static TTask Load(const TSlot& s)
+  {
+    TTask t = { s.job.load(std::memory_order_relaxed), s.begin.load(std::memory_order_relaxed),
+      s.end.load(std::memory_order_relaxed) };
+    return t;
+  }
+
+public:
+  // false - очередь заполнена (порция выполняется владельцем без деления)
+  bool Push(const TTask& t)
+  {
+    const long long b = bottom.load(std::memory_order_relaxed);
+    const long long tp = top.load(std::memory_order_acquire);
+    if (b - tp >= CAPACITY)
+      return false;
+    TSlot& s = slots[b % CAPACITY];
+    s.job.store(t.job, std::memory_order_relaxed);
+    s.begin.store(t.begin, std::memory_order_relaxed);
+    s.end.store(t.end, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool Pop(TTask& t)
+  {
+    const long long b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long tp = top.load(std::memory_order_relaxed);
+    if (tp > b)
+    {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    t = Load(slots[b % CAPACITY]);
+    if (tp == b)
+    {
+      // последняя порция: соревнуемся с перехватывающими
+      const bool won = top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  bool Steal(TTask& t)
+  {
+    long long tp = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const long long b = bottom.load(std::memory_order_acquire);
+    if (tp >= b)
+      return false;
+    t = Load(slots[tp % CAPACITY]);
+    return top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+};
+
+// Пул: очередь 0 принадлежит потоку, запустившему задание извне,
+// очереди 1..n-1 - рабочим потокам. Пока есть активные задания, рабочие
+// потоки перехватывают порции, иначе спят на условной переменной
+class TThreadPool
+{
+  std::vector<std::thread> workers;
+  std::unique_ptr<TWorkDeque[]> deques;
+  // меняется в Resize под submit, читается без блокировки (Size)
+  std::atomic<size_t> count{1};
+
+  std::mutex mtx;
+  std::condition_variable wake;
+  std::mutex submit; // одно внешнее задание за раз
+  std::atomic<int> active{0};
+  bool stop = false;
+
+  static thread_local TWorkDeque* own;
+  static thread_local size_t ownIndex;
+
+  bool StealAny(TWorkDeque::TTask& t)
+  {
+    const size_t n = count.load(std::memory_order_relaxed);
+    for (size_t k = 1; k < n; k++)
+      if (deques[(ownIndex + k) % n].Steal(t))
+        return true;
+    return false;
+  }
+
+  // Выполнение порции: пока она больше зерна, вторая половина откладывается
+  void Execute(TWorkDeque::TTask t)
+  {
+    while (t.end - t.begin > t.job->grain)
+    {
+      const size_t mid = t.begin + (t.end - t.begin) / 2;
+      TWorkDeque::TTask half = { t.job, mid, t.end };
+      if (!own->Push(half))
+        break;
+      t.end = mid;
+    }
+    if (!t.job->failed.load(std::memory_order_relaxed))
+    {
+#ifdef MP2_STATS
+      const TOpStats before = StatsGet();
+#endif
+      try
+      {
+        (*t.job->f)(t.begin, t.end);
+      }
+      catch (...)
+      {
+        if (!t.job->failed.exchange(true, std::memory_order_relaxed))
+          t.job->error = std::current_exception();
+      }
+#ifdef MP2_STATS
+      if (&StatsLocal() != t.job->owner)
+      {
+        const TOpStats delta = StatsGet() - before;
+        StatsLocal() = before;
+        std::lock_guard<std::mutex> lock(t.job->statsMutex);
+        t.job->stats = t.job->stats + delta;
+      }
+#endif
+    }
+    t.job->pending.fetch_sub(t.end - t.begin, std::memory_order_release);
+  }
+
+  // Выполнение задания и помощь другим, пока задание не завершено
+  void Join(TParallelJob& job, size_t n)
+  {
+    TWorkDeque::TTask t = { &job, 0, n };
+    Execute(t);
+    while (job.pending.load(std::memory_order_acquire) != 0)
+    {
+      if (own->Pop(t) || StealAny(t))
+        Execute(t);
+      else
+        std::this_thread::yield();
+    }
+#ifdef MP2_STATS
+    std::lock_guard<std::mutex> lock(job.statsMutex);
+    StatsLocal() = StatsLocal() + job.stats;
+#endif
+  }
+
+  void Worker(size_t id, bool pin)
+  {
+#if defined(__linux__)
+    if (pin)
+    {
+      // рабочий поток id - на ядро id; ядро 0 остается вызывающему потоку,
+      // привязка которого не меняется
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(id % CPU_SETSIZE, &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#else
+    (void)pin;
+#endif
+    own = &deques[id];
+    ownIndex = id;
+    for (;;)
+    {
+      if (active.load(std::memory_order_acquire) == 0)
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        wake.wait(lock, [&] { return stop || active.load(std::memory_order_acquire) != 0; });
+        if (stop)
+          return;
+      }
+      TWorkDeque::TTask t;
+      if (own->Pop(t) || StealAny(t))
+        Execute(t);
+      else
+        std::this_thread::yield();
+    }
+  }
+
+  void Stop()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+    wake.notify_all();
+    for (std::thread& w : workers)
+      w.join();
+    workers.clear();
+    stop = false;
+  }
+
+public:
+  TThreadPool() { Resize(0, false); }
+  ~TThreadPool() { Stop(); }
+
+  size_t Size() const noexcept { return count.load(std::memory_order_relaxed); }
+
+  size_t Resize(size_t n, bool pin)
+  {
+    if (n == 0)
+      n = std::thread::hardware_concurrency();
+    if (n == 0)
+      n = 1;
+    std::lock_guard<std::mutex> lock(submit);
+    Stop();
+    deques.reset(new TWorkDeque[n]);
+    count.store(n, std::memory_order_relaxed);
+    for (size_t i = 1; i < n; i++)
+      workers.emplace_back(&TThreadPool::Worker, this, i, pin);
+    return n;
+  }
+
+  void Range(size_t n, size_t grain, const std::function<void(size_t, size_t)>& f)
+  {
+    if (grain == 0)
+      grain = 1;
+    TParallelJob job;
+    job.f = &f;
+    job.grain = grain;
+    job.pending.store(n, std::memory_order_relaxed);
+    if (own != nullptr)
+    {
+      // вложенный вызов: порции идут в очередь текущего потока
+      Join(job, n);
+      job.Rethrow();
+      return;
+    }
+    std::unique_lock<std::mutex> busy(submit, std::try_to_lock);
+    if (!busy.owns_lock() || count.load(std::memory_order_relaxed) == 1)
+    {
+      f(0, n);
+      return;
+    }
+    own = &deques[0];
+    ownIndex = 0;
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      active.fetch_add(1, std::memory_order_release);
+    }
+    wake.notify_all();
+    Join(job, n);
+    active.fetch_sub(1, std::memory_order_release);
+    own = nullptr;
+    job.Rethrow();
+  }
+};
+
+thread_local TWorkDeque* TThreadPool::own = nullptr;
+thread_local size_t TThreadPool::ownIndex = 0;
+
+static TThreadPool& Pool()
+{
+  static TThreadPool pool;
+  return pool;
+}
+
+size_t ParallelThreadCount()
+{
+  return Pool().Size();
+}
+
+size_t ParallelSetThreadCount(size_t n, bool pin)
+{
+  return Pool().Resize(n, pin);
+}
+
+void ParallelRange(size_t n, size_t grain, const std::function<void(size_t, size_t)>& f)
+{
+  if (n == 0)
+    return;
+  Pool().Range(n, grain, f);
+}
+
+void ParallelFor(size_t n, const std::function<void(size_t)>& f)
+{
+  ParallelRange(n, 1, [&f](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
+      f(i);
+  });
+}
+
+size_t ParallelGrain(size_t n, size_t cost)
+{
+  if (cost == 0)
+    cost = 1;
+  const size_t minGrain = (PARALLEL_MIN_WORK + cost - 1) / cost;
+  const size_t threads = ParallelThreadCount();
+  if (threads == 1)
+    return n;
+  const size_t grain = (n + 4 * threads - 1) / (4 * threads);
+  return grain < minGrain ? minGrain : grain;
+}
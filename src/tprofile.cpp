@@ -0,0 +1,221 @@
+#include "tprofile.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static std::atomic<bool> profileEnabled(false);
+// -1 - не проверялось, 0 - недоступно, 1 - доступно
+static std::atomic<int> eventAvailable[PROFILE_EVENTS] = { {-1}, {-1}, {-1}, {-1}, {-1} };
+
+static std::mutex profileMutex;
+static std::vector<TProfileRecord> profileRecords;
+
+// Счетчики потока: группа perf_event, лидер - первое открывшееся событие,
+// все значения группы читаются одним вызовом read
+class TProfileCounters
+{
+  int leader = -1;
+  int fds[PROFILE_EVENTS];
+  // номер события в ответе read (-1 - событие не открылось)
+  int slot[PROFILE_EVENTS];
+  int opened = 0;
+
+public:
+  TProfileCounters()
+  {
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+      fds[e] = slot[e] = -1;
+#if defined(__linux__)
+    static const uint32_t types[PROFILE_EVENTS] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE
+    };
+    static const uint64_t configs[PROFILE_EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[e];
+      attr.config = configs[e];
+      attr.read_format = PERF_FORMAT_GROUP;
+      // только пользовательский код: доступно при perf_event_paranoid <= 2
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      const int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+      if (fd >= 0)
+      {
+        if (leader < 0)
+          leader = fd;
+        fds[e] = fd;
+        slot[e] = opened++;
+      }
+      int expected = -1;
+      eventAvailable[e].compare_exchange_strong(expected, fd >= 0 ? 1 : 0);
+    }
+#else
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+    {
+      int expected = -1;
+      eventAvailable[e].compare_exchange_strong(expected, 0);
+    }
+#endif
+  }
+
+  ~TProfileCounters()
+  {
+#if defined(__linux__)
+    for (int e = PROFILE_EVENTS; e-- > 0;)
+      if (fds[e] >= 0)
+        close(fds[e]);
+#endif
+  }
+
+  bool Any() const { return leader >= 0; }
+
+  void Read(uint64_t* values) const
+  {
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+      values[e] = 0;
+#if defined(__linux__)
+    if (leader < 0)
+      return;
+    uint64_t buf[PROFILE_EVENTS + 1];
+    if (read(leader, buf, sizeof(buf)) < ssize_t(sizeof(uint64_t) * (opened + 1)))
+      return;
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+      if (slot[e] >= 0)
+        values[e] = buf[1 + slot[e]];
+#endif
+  }
+
+  static const TProfileCounters& Local()
+  {
+    static thread_local TProfileCounters counters;
+    return counters;
+  }
+};
+
+bool ProfileSetEnabled(bool enable)
+{
+  // счетчики открываются здесь, а не внутри первой области
+  const bool any = TProfileCounters::Local().Any();
+  profileEnabled.store(enable, std::memory_order_relaxed);
+  return any;
+}
+
+bool ProfileEnabled()
+{
+  return profileEnabled.load(std::memory_order_relaxed);
+}
+
+bool ProfileEventAvailable(TProfileEvent e)
+{
+  return eventAvailable[e].load(std::memory_order_relaxed) == 1;
+}
+
+const char* ProfileEventName(TProfileEvent e)
+{
+  static const char* const names[PROFILE_EVENTS] = { "cycles", "instructions", "L1D-misses", "LLC-misses", "branch-misses" };
+  return names[e];
+}
+
+std::vector<TProfileRecord> ProfileResults()
+{
+  std::lock_guard<std::mutex> lock(profileMutex);
+  return profileRecords;
+}
+
+void ProfileReset()
+{
+  std::lock_guard<std::mutex> lock(profileMutex);
+  profileRecords.clear();
+}
+
+void ProfilePrint(std::ostream& os)
+{
+  const std::vector<TProfileRecord> records = ProfileResults();
+  os << std::left << std::setw(20) << "region" << std::right << std::setw(10) << "calls" << std::setw(12) << "ms";
+  for (int e = 0; e < PROFILE_EVENTS; e++)
+    os << std::setw(15) << ProfileEventName(TProfileEvent(e));
+  os << std::setw(7) << "IPC" << std::endl;
+  for (const TProfileRecord& r : records)
+  {
+    os << std::left << std::setw(20) << r.name << std::right << std::setw(10) << r.calls
+      << std::fixed << std::setprecision(3) << std::setw(12) << double(r.ns) / 1e6 << std::defaultfloat;
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+    {
+      if (ProfileEventAvailable(TProfileEvent(e)))
+        os << std::setw(15) << r.events[e];
+      else
+        os << std::setw(15) << "n/a";
+    }
+    if (ProfileEventAvailable(PROFILE_CYCLES) && ProfileEventAvailable(PROFILE_INSTRUCTIONS) && r.events[PROFILE_CYCLES] > 0)
+      os << std::fixed << std::setprecision(2) << std::setw(7)
+        << double(r.events[PROFILE_INSTRUCTIONS]) / double(r.events[PROFILE_CYCLES]) << std::defaultfloat;
+    else
+      os << std::setw(7) << "n/a";
+    os << std::endl;
+  }
+}
+
+#ifdef MP2_PROFILE
+
+static uint64_t ProfileNow()
+{
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TProfileScope::TProfileScope(const char* _name) : name(_name), active(profileEnabled.load(std::memory_order_relaxed))
+{
+  if (!active)
+    return;
+  start[PROFILE_EVENTS] = ProfileNow();
+  TProfileCounters::Local().Read(start);
+}
+
+TProfileScope::~TProfileScope()
+{
+  if (!active)
+    return;
+  uint64_t stop[PROFILE_EVENTS + 1];
+  TProfileCounters::Local().Read(stop);
+  stop[PROFILE_EVENTS] = ProfileNow();
+
+  std::lock_guard<std::mutex> lock(profileMutex);
+  TProfileRecord* r = nullptr;
+  for (TProfileRecord& x : profileRecords)
+    if (x.name == name)
+    {
+      r = &x;
+      break;
+    }
+  if (r == nullptr)
+  {
+    profileRecords.emplace_back();
+    r = &profileRecords.back();
+    r->name = name;
+  }
+  r->calls++;
+  r->ns += stop[PROFILE_EVENTS] - start[PROFILE_EVENTS];
+  for (int e = 0; e < PROFILE_EVENTS; e++)
+    r->events[e] += stop[e] - start[e];
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "tsimd.h"
+
+#include <atomic>
+
+// Обобщенные ядра; каждый набор инструкций получает свою копию,
+// которую компилятор векторизует под соответствующую архитектуру
+
+#if defined(__GNUC__)
+#define MP2_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define MP2_ALWAYS_INLINE inline
+#endif
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelAdd(const T* a, const T* b, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] + b[i];
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelSub(const T* a, const T* b, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] - b[i];
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelAddScalar(const T* a, T val, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] + val;
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelSubScalar(const T* a, T val, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] - val;
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelMulScalar(const T* a, T val, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] * val;
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelDivScalar(const T* a, T val, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i] / val;
+}
+
+template<typename T>
+MP2_ALWAYS_INLINE void KernelNeg(const T* a, T* r, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    r[i] = -a[i];
+}
+
+// Скалярное произведение накапливается в DOT_LANES независимых суммах,
+// чтобы цикл векторизовался без переупорядочивания одной суммы
+template<typename T>
+MP2_ALWAYS_INLINE T KernelDot(const T* a, const T* b, size_t n)
+{
+  const size_t DOT_LANES = 16;
+  T acc[DOT_LANES] = {};
+  size_t i = 0;
+  for (; i + DOT_LANES <= n; i += DOT_LANES)
+    for (size_t j = 0; j < DOT_LANES; j++)
+      acc[j] += a[i + j] * b[i + j];
+  T s = T();
+  for (size_t j = 0; j < DOT_LANES; j++)
+    s += acc[j];
+  for (; i < n; i++)
+    s += a[i] * b[i];
+  return s;
+}
+
+#define MP2_SIMD_KERNELS(NAME, ATTR) \
+template<typename T> \
+struct NAME \
+{ \
+  ATTR static void Add(const T* a, const T* b, T* r, size_t n) { KernelAdd(a, b, r, n); } \
+  ATTR static void Sub(const T* a, const T* b, T* r, size_t n) { KernelSub(a, b, r, n); } \
+  ATTR static void AddScalar(const T* a, T val, T* r, size_t n) { KernelAddScalar(a, val, r, n); } \
+  ATTR static void SubScalar(const T* a, T val, T* r, size_t n) { KernelSubScalar(a, val, r, n); } \
+  ATTR static void MulScalar(const T* a, T val, T* r, size_t n) { KernelMulScalar(a, val, r, n); } \
+  ATTR static void DivScalar(const T* a, T val, T* r, size_t n) { KernelDivScalar(a, val, r, n); } \
+  ATTR static void Neg(const T* a, T* r, size_t n) { KernelNeg(a, r, n); } \
+  ATTR static T Dot(const T* a, const T* b, size_t n) { return KernelDot(a, b, n); } \
+  static TSimdKernels<T> Table() \
+  { \
+    TSimdKernels<T> t = { &Add, &Sub, &AddScalar, &SubScalar, &MulScalar, &DivScalar, &Neg, &Dot }; \
+    return t; \
+  } \
+};
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MP2_SIMD_X86
+MP2_SIMD_KERNELS(TScalarKernels, __attribute__((optimize("no-tree-vectorize"))))
+MP2_SIMD_KERNELS(TSse2Kernels, __attribute__((target("sse2"))))
+MP2_SIMD_KERNELS(TAvx2Kernels, __attribute__((target("avx2"))))
+MP2_SIMD_KERNELS(TAvx512Kernels, __attribute__((target("avx512f,avx512dq"))))
+#else
+MP2_SIMD_KERNELS(TScalarKernels, )
+#endif
+
+static TSimdKernelSet DetectKernelSet()
+{
+#ifdef MP2_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+    return SIMD_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return SIMD_AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return SIMD_SSE2;
+#endif
+  return SIMD_SCALAR;
+}
+
+static std::atomic<int>& SelectedKernelSet()
+{
+  static std::atomic<int> selected(DetectKernelSet());
+  return selected;
+}
+
+template<typename T>
+static const TSimdKernels<T>& SelectKernels()
+{
+#ifdef MP2_SIMD_X86
+  static const TSimdKernels<T> tables[] = {
+    TScalarKernels<T>::Table(),
+    TSse2Kernels<T>::Table(),
+    TAvx2Kernels<T>::Table(),
+    TAvx512Kernels<T>::Table()
+  };
+  return tables[SelectedKernelSet().load(std::memory_order_relaxed)];
+#else
+  static const TSimdKernels<T> table = TScalarKernels<T>::Table();
+  return table;
+#endif
+}
+
+template<> const TSimdKernels<float>& SimdKernels<float>() { return SelectKernels<float>(); }
+template<> const TSimdKernels<double>& SimdKernels<double>() { return SelectKernels<double>(); }
+template<> const TSimdKernels<int32_t>& SimdKernels<int32_t>() { return SelectKernels<int32_t>(); }
+template<> const TSimdKernels<int64_t>& SimdKernels<int64_t>() { return SelectKernels<int64_t>(); }
+
+TSimdKernelSet SimdKernelSet()
+{
+  return TSimdKernelSet(SelectedKernelSet().load(std::memory_order_relaxed));
+}
+
+const char* SimdKernelSetName()
+{
+  switch (SimdKernelSet())
+  {
+  case SIMD_SSE2:
+    return "sse2";
+  case SIMD_AVX2:
+    return "avx2";
+  case SIMD_AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+TSimdKernelSet SimdMaxKernelSet()
+{
+  static const TSimdKernelSet maxSet = DetectKernelSet();
+  return maxSet;
+}
+
+TSimdKernelSet SimdSelectKernelSet(TSimdKernelSet s)
+{
+  if (s > SimdMaxKernelSet())
+    s = SimdMaxKernelSet();
+  SelectedKernelSet().store(s, std::memory_order_relaxed);
+  return s;
+}
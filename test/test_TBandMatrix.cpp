@@ -0,0 +1,228 @@
+#include "TBandMatrix.h"
+
+#include <gtest.h>
+
+TEST(TBandMatrix, can_create_band_matrix)
+{
+	ASSERT_NO_THROW(TBandMatrix<int> m(10, 2, 1));
+}
+
+TEST(TBandMatrix, cant_create_band_matrix_with_too_wide_band)
+{
+	ASSERT_ANY_THROW(TBandMatrix<int> m(3, 3, 0));
+	ASSERT_ANY_THROW(TBandMatrix<int> m(3, 0, 3));
+	ASSERT_ANY_THROW(TBandMatrix<int> m(0, 0, 0));
+}
+
+TEST(TBandMatrix, band_stores_only_diagonals)
+{
+	TBandMatrix<int> m(5, 1, 2, 7);
+	EXPECT_EQ(7, m(2, 1));
+	EXPECT_EQ(7, m(2, 4));
+	const TBandMatrix<int>& c = m;
+	EXPECT_EQ(0, c(2, 0));
+	EXPECT_EQ(0, c(0, 4));
+	ASSERT_ANY_THROW(m.at(2, 0));
+	ASSERT_ANY_THROW(m.at(5, 5));
+	ASSERT_NO_THROW(c.at(2, 0));
+}
+
+TEST(TBandMatrix, non_const_access_outside_band_throws)
+{
+	TBandMatrix<int> m(5, 1, 1, 3);
+	ASSERT_ANY_THROW(m(0, 4));
+	ASSERT_ANY_THROW(m(4, 0));
+	ASSERT_ANY_THROW(m(0, 2) = 1);
+	EXPECT_EQ(3, m(0, 1));
+	EXPECT_EQ(3, m(4, 3));
+}
+
+TEST(TBandMatrix, band_product_equals_dense_product)
+{
+	const size_t size = 40;
+	TBandMatrix<int> m(size, 2, 3);
+	TDynamicVector<int> v(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		v[i] = int(i % 7) - 3;
+		for (size_t j = i > 2 ? i - 2 : 0; j < size && j <= i + 3; j++)
+			m(i, j) = int(i + 2 * j) % 5 - 2;
+	}
+	TDynamicMatrix<int> d(m);
+	EXPECT_EQ(d * v, m * v);
+	ASSERT_ANY_THROW(m * TDynamicVector<int>(size + 1));
+}
+
+TEST(TBandMatrix, can_solve_tridiagonal_system)
+{
+	const size_t size = 50;
+	TBandMatrix<double> m(size, 1, 1);
+	TDynamicVector<double> x(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		m(i, i) = 4;
+		if (i > 0)
+			m(i, i - 1) = -1;
+		if (i + 1 < size)
+			m(i, i + 1) = -1;
+		x[i] = double(i % 3) - 1;
+	}
+	TDynamicVector<double> r = m.Solve(m * x);
+	for (size_t i = 0; i < size; i++)
+		EXPECT_NEAR(x[i], r[i], 1e-12);
+}
+
+TEST(TBandMatrix, can_solve_band_system_that_needs_pivoting)
+{
+	TBandMatrix<int> m(4, 1, 1);
+	m(0, 0) = 0;
+	m(0, 1) = 1;
+	m(1, 0) = 2;
+	m(1, 1) = 1;
+	m(1, 2) = 1;
+	m(2, 1) = 3;
+	m(2, 2) = 1;
+	m(2, 3) = 2;
+	m(3, 2) = 1;
+	m(3, 3) = 1;
+	TDynamicVector<int> x(4);
+	x[0] = 1;
+	x[1] = -2;
+	x[2] = 3;
+	x[3] = 4;
+	EXPECT_EQ(x, m.Solve(m * x));
+	EXPECT_EQ(TDynamicMatrix<int>(m).Det(), m.Det());
+}
+
+TEST(TBandMatrix, integer_solve_and_det_match_dense_matrix)
+{
+	// pseudo-random small nonzero entries, several band shapes;
+	// m(0, 0) = 0 forces a row exchange
+	const size_t size = 9;
+	const size_t shapes[][2] = { { 0, 0 }, { 1, 1 }, { 2, 1 }, { 1, 3 }, { 3, 2 } };
+	unsigned seed = 7;
+	for (const auto& shape : shapes)
+	{
+		TBandMatrix<long long> m(size, shape[0], shape[1]);
+		for (size_t i = 0; i < size; i++)
+			for (size_t j = i > shape[0] ? i - shape[0] : 0; j < size && j <= i + shape[1]; j++)
+			{
+				seed = seed * 1103515245 + 12345;
+				const int v = int((seed >> 16) % 6) - 3;
+				m(i, j) = v < 0 ? v : v + 1;
+			}
+		if (shape[0] > 0)
+			m(0, 0) = 0;
+		m(size - 1, size - 1) = 5;
+		TDynamicMatrix<long long> d(m);
+		TDynamicVector<long long> b(size);
+		for (size_t i = 0; i < size; i++)
+			b[i] = int(i * i) - 20;
+		EXPECT_EQ(d.Det(), m.Det());
+		if (d.Det() != 0)
+		{
+			EXPECT_EQ(Solve(d, b), m.Solve(b));
+			EXPECT_EQ(Solve(d, d), m.Solve(d));
+		}
+	}
+}
+
+TEST(TBandMatrix, integer_det_is_exact_beyond_double_precision)
+{
+	// unit leading minors and det = 2^53 + 1, which double cannot represent
+	const size_t size = 6;
+	const long long det = (1LL << 53) + 1;
+	TBandMatrix<long long> m(size, 1, 1);
+	for (size_t i = 0; i < size; i++)
+		m(i, i) = 1;
+	for (size_t i = 0; i + 1 < size; i++)
+		m(i + 1, i) = 1;
+	m(size - 1, size - 1) = det;
+	EXPECT_EQ(det, m.Det());
+	EXPECT_EQ(TDynamicMatrix<long long>(m).Det(), m.Det());
+	// solution x = b / 3 is truncated toward zero, as for TDynamicMatrix
+	TBandMatrix<long long> diag(4, 1, 1);
+	for (size_t i = 0; i < 4; i++)
+		diag(i, i) = 3;
+	TDynamicVector<long long> b(4, 8), x(4, 2);
+	b[1] = -8;
+	x[1] = -2;
+	EXPECT_EQ(x, diag.Solve(b));
+	EXPECT_EQ(Solve(TDynamicMatrix<long long>(diag), b), diag.Solve(b));
+}
+
+TEST(TBandMatrix, can_solve_system_with_matrix_right_side)
+{
+	const size_t size = 6;
+	TBandMatrix<double> m(size, 2, 1);
+	TDynamicMatrix<double> x(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		for (size_t j = i > 2 ? i - 2 : 0; j < size && j <= i + 1; j++)
+			m(i, j) = double(i + j) - 4;
+		for (size_t j = 0; j < size; j++)
+			x[i][j] = double(i * j % 5);
+	}
+	TDynamicMatrix<double> d(m);
+	TDynamicMatrix<double> r = m.Solve(d * x);
+	for (size_t i = 0; i < size; i++)
+		for (size_t j = 0; j < size; j++)
+			EXPECT_NEAR(x[i][j], r[i][j], 1e-9);
+}
+
+TEST(TBandMatrix, cant_solve_system_with_singular_matrix)
+{
+	TBandMatrix<double> m(4, 1, 1);
+	TDynamicVector<double> b(4, 1.0);
+	ASSERT_ANY_THROW(m.Solve(b));
+	EXPECT_EQ(0.0, m.Det());
+}
+
+TEST(TBandMatrix, cant_solve_singular_system_with_weak_diagonal_dominance)
+{
+	TBandMatrix<double> m(2, 1, 1, 1.0);
+	TDynamicVector<double> b(2, 1.0);
+	ASSERT_ANY_THROW(m.Solve(b));
+}
+
+TEST(TBandMatrix, cant_solve_singular_neumann_laplacian)
+{
+	const size_t size = 3;
+	TBandMatrix<double> m(size, 1, 1);
+	TBandMatrix<int> k(size, 1, 1);
+	for (size_t i = 0; i < size; i++)
+	{
+		m(i, i) = k(i, i) = i == 0 || i + 1 == size ? 1 : 2;
+		if (i > 0)
+			m(i, i - 1) = k(i, i - 1) = -1;
+		if (i + 1 < size)
+			m(i, i + 1) = k(i, i + 1) = -1;
+	}
+	ASSERT_ANY_THROW(m.Solve(TDynamicVector<double>(size, 1.0)));
+	ASSERT_ANY_THROW(m.Solve(TDynamicMatrix<double>(size, 1.0)));
+	ASSERT_ANY_THROW(k.Solve(TDynamicVector<int>(size, 1)));
+}
+
+TEST(TBandMatrix, can_solve_weakly_dominant_nonsingular_system)
+{
+	// rows 1 and 2 are only weakly dominant, the matrix is nonsingular
+	TBandMatrix<double> m(3, 1, 1);
+	m(0, 0) = 2; m(0, 1) = -1;
+	m(1, 0) = -1; m(1, 1) = 2; m(1, 2) = -1;
+	m(2, 1) = -1; m(2, 2) = 1;
+	TDynamicVector<double> x(3);
+	x[0] = 1; x[1] = -2; x[2] = 3;
+	TDynamicVector<double> r = m.Solve(m * x);
+	for (size_t i = 0; i < 3; i++)
+		EXPECT_NEAR(x[i], r[i], 1e-12);
+}
+
+TEST(TBandMatrix, can_use_expressions)
+{
+	TBandMatrix<int> a(5, 1, 2, 3), b(5, 1, 2, 1), c(5, 2, 1, 1);
+	TBandMatrix<int> m = a * 2 - b;
+	EXPECT_EQ(TBandMatrix<int>(5, 1, 2, 5), m);
+	m += b;
+	EXPECT_EQ(TBandMatrix<int>(5, 1, 2, 6), m);
+	ASSERT_ANY_THROW(a + c);
+}
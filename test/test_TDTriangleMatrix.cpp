@@ -230,4 +230,124 @@ TEST(TDTriangleMatrix, cant_multiply_dtriangle_matrices_with_not_equal_size)
   const size_t size1 = 2, size2 = 4;
   TDTriangleMatrix<int> m1(size1), m2(size2);
   ASSERT_ANY_THROW(m1 * m2);
-}
\ No newline at end of file
+}
+TEST(TDTriangleMatrix, can_solve_dtriangle_system)
+{
+  const size_t size = 3;
+  TDTriangleMatrix<int> m(size);
+  TDynamicVector<int> x(size);
+
+  m(0, 0) = 2;
+  m(1, 0) = 1;
+  m(1, 1) = -1;
+  m(2, 0) = 3;
+  m(2, 1) = 2;
+  m(2, 2) = 4;
+
+  x[0] = 1;
+  x[1] = -2;
+  x[2] = 3;
+
+  EXPECT_EQ(x, m.Solve(m * x));
+}
+
+TEST(TDTriangleMatrix, can_solve_dtriangle_system_with_unit_diagonal)
+{
+  const size_t size = 3;
+  TDTriangleMatrix<int> m(size, 5);
+  TDynamicVector<int> b(size), x(size);
+
+  b[0] = 1;
+  b[1] = 7;
+  b[2] = 36;
+
+  x[0] = 1;
+  x[1] = 2;
+  x[2] = 21;
+
+  EXPECT_EQ(x, m.Solve(b, true));
+}
+
+TEST(TDTriangleMatrix, can_solve_dtriangle_system_with_matrix_right_side)
+{
+  const size_t size = 3;
+  TDTriangleMatrix<double> m(size);
+  TDynamicMatrix<double> b(size);
+
+  m(0, 0) = 2;
+  m(1, 0) = 1;
+  m(1, 1) = -1;
+  m(2, 0) = 3;
+  m(2, 1) = 2;
+  m(2, 2) = 4;
+
+  double k = 1;
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      b[i][j] = k++;
+  TDynamicMatrix<double> x = m.Solve(b);
+  for (size_t j = 0; j < size; j++)
+  {
+    TDynamicVector<double> col(size);
+    for (size_t i = 0; i < size; i++)
+      col[i] = b[i][j];
+    TDynamicVector<double> res = m.Solve(col);
+    for (size_t i = 0; i < size; i++)
+      EXPECT_DOUBLE_EQ(res[i], x[i][j]);
+  }
+}
+
+TEST(TDTriangleMatrix, cant_solve_dtriangle_system_with_zero_on_diagonal)
+{
+  TDTriangleMatrix<int> m(3, 1);
+  TDynamicVector<int> b(3, 1);
+  m(1, 1) = 0;
+  ASSERT_ANY_THROW(m.Solve(b));
+}
+
+TEST(TDTriangleMatrix, rows_are_packed_in_one_buffer)
+{
+  TDTriangleMatrix<int> m(4);
+  for (size_t i = 1; i < 4; i++)
+    EXPECT_EQ(m[i - 1].data() + i, m[i].data());
+}
+
+TEST(TDTriangleMatrix, can_evaluate_chained_expression)
+{
+	TDTriangleMatrix<int> a(3, 2), b(3, 1);
+	TDTriangleMatrix<int> m = -(a * 2 - b) + a;
+	EXPECT_EQ(TDTriangleMatrix<int>(3, -1), m);
+}
+
+TEST(TDTriangleMatrix, expression_indexes_like_matrix)
+{
+	TDTriangleMatrix<int> a(3, 1), b(3, 2);
+	EXPECT_EQ(3, (a + b).size());
+	EXPECT_EQ(TDynamicVector<int>(2, 3), TDynamicVector<int>((a + b)[1]));
+	EXPECT_EQ(3, (a + b)[2][2]);
+	EXPECT_EQ((a + b) * b, TDTriangleMatrix<int>(a + b) * b);
+}
+
+TEST(TDTriangleMatrix, can_use_compound_assignment)
+{
+	TDTriangleMatrix<int> a(3, 2), b(3, 1);
+	a += b;
+	a *= 4;
+	a -= b * 2;
+	a /= 5;
+	EXPECT_EQ(TDTriangleMatrix<int>(3, 2), a);
+}
+
+TEST(TDTriangleMatrix, multiply_assign_equals_product)
+{
+	const size_t size = 5;
+	TDTriangleMatrix<int> a(size, 1), b(size, 2);
+	a(2, 2) = 3;
+	b(size - 1, size - 1) = -1;
+	TDTriangleMatrix<int> ab = a * b, aa = a * a;
+	TDTriangleMatrix<int> c(a);
+	c *= b;
+	EXPECT_EQ(ab, c);
+	a *= a;
+	EXPECT_EQ(aa, a);
+}
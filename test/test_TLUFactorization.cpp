@@ -0,0 +1,146 @@
+#include "TLUFactorization.h"
+#include "test_alloc.h"
+
+#include <gtest.h>
+
+TEST(TLUFactorization, can_factorize_matrix)
+{
+  TDynamicMatrix<double> m(3, 1.0);
+  ASSERT_NO_THROW(TLUFactorization<double> lu(m));
+}
+
+TEST(TLUFactorization, can_get_size)
+{
+  TDynamicMatrix<double> m(4);
+  TLUFactorization<double> lu(m);
+  EXPECT_EQ(4, lu.size());
+}
+
+TEST(TLUFactorization, singular_matrix_is_detected)
+{
+  TDynamicMatrix<int> m(3, 2);
+  TLUFactorization<int> lu(m);
+  EXPECT_EQ(true, lu.IsSingular());
+  EXPECT_EQ(0, lu.Det());
+}
+
+TEST(TLUFactorization, can_find_determinant)
+{
+  TDynamicMatrix<int> m(3);
+
+  m[0][0] = 1;
+  m[0][1] = 3;
+  m[0][2] = 3;
+
+  m[1][0] = 2;
+  m[1][1] = 7;
+  m[1][2] = 11;
+
+  m[2][0] = 3;
+  m[2][1] = 4;
+  m[2][2] = 2;
+  TLUFactorization<int> lu(m);
+  EXPECT_EQ(18, lu.Det());
+}
+
+TEST(TLUFactorization, can_solve_several_systems_with_one_factorization)
+{
+  const size_t size = 5;
+  TDynamicMatrix<double> m(size, 1.0);
+  for (size_t i = 0; i < size; i++)
+    m[i][i] = 10.0;
+  TLUFactorization<double> lu(m);
+  for (int k = 1; k <= 3; k++)
+  {
+    TDynamicVector<double> x(size);
+    for (size_t i = 0; i < size; i++)
+      x[i] = double(k * i) - 2.0;
+    TDynamicVector<double> res = lu.Solve(m * x);
+    for (size_t i = 0; i < size; i++)
+      EXPECT_NEAR(x[i], res[i], 1e-12);
+  }
+}
+
+TEST(TLUFactorization, can_solve_system_with_matrix_right_side)
+{
+  TDynamicMatrix<int> m(3), X(3);
+  int k = 1;
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+      X[i][j] = k++;
+  m[0][0] = 0;
+  m[0][1] = 2;
+  m[0][2] = 1;
+
+  m[1][0] = 1;
+  m[1][1] = 0;
+  m[1][2] = 3;
+
+  m[2][0] = 4;
+  m[2][1] = 1;
+  m[2][2] = 0;
+  TLUFactorization<int> lu(m);
+  EXPECT_EQ(X, lu.Solve(m * X));
+}
+
+TEST(TLUFactorization, can_get_inverse_matrix)
+{
+  TDynamicMatrix<int> m(3), inv(3);
+
+  m[0][0] = 2;
+  m[0][1] = 5;
+  m[0][2] = 7;
+
+  m[1][0] = 6;
+  m[1][1] = 3;
+  m[1][2] = 4;
+
+  m[2][0] = 5;
+  m[2][1] = -2;
+  m[2][2] = -3;
+
+  inv[0][0] = 1;
+  inv[0][1] = -1;
+  inv[0][2] = 1;
+
+  inv[1][0] = -38;
+  inv[1][1] = 41;
+  inv[1][2] = -34;
+
+  inv[2][0] = 27;
+  inv[2][1] = -29;
+  inv[2][2] = 24;
+  TLUFactorization<int> lu(m);
+  EXPECT_EQ(inv, lu.Inverse());
+}
+
+TEST(TLUFactorization, cant_solve_system_with_singular_matrix)
+{
+  TDynamicMatrix<double> m(3, 1.0);
+  TDynamicVector<double> b(3, 1.0);
+  TLUFactorization<double> lu(m);
+  ASSERT_ANY_THROW(lu.Solve(b));
+  ASSERT_ANY_THROW(lu.Inverse());
+}
+
+TEST(TLUFactorization, cant_solve_system_with_not_equal_size)
+{
+  TDynamicMatrix<double> m(3, 1.0);
+  TDynamicVector<double> b(4, 1.0);
+  TLUFactorization<double> lu(m);
+  ASSERT_ANY_THROW(lu.Solve(b));
+}
+
+TEST(TLUFactorization, solutions_keep_allocator_of_matrix)
+{
+  typedef TTaggedAllocator<double> TTagged;
+  TDynamicMatrix<double, TTagged> m(3, 0.0, TTagged(1));
+  for (size_t i = 0; i < 3; i++)
+    m[i][i] = 2;
+  TLUFactorization<double, TTagged> lu(m);
+  EXPECT_EQ(1, lu.get_allocator().tag);
+  EXPECT_EQ(1, lu.Solve(TDynamicVector<double, TTagged>(3, 4.0, TTagged(2))).get_allocator().tag);
+  TDynamicMatrix<double, TTagged> inv = lu.Inverse();
+  EXPECT_EQ(1, inv.get_allocator().tag);
+  EXPECT_EQ(0.5, inv[2][2]);
+}
@@ -0,0 +1,146 @@
+#include "TRectMatrix.h"
+#include "test_alloc.h"
+
+#include <gtest.h>
+
+TEST(TRectMatrix, can_create_rect_matrix)
+{
+	TRectMatrix<int> m(100, 3, 7);
+	EXPECT_EQ(100, m.rows());
+	EXPECT_EQ(3, m.cols());
+	EXPECT_EQ(7, m[99][2]);
+}
+
+TEST(TRectMatrix, cant_create_rect_matrix_with_zero_or_too_large_size)
+{
+	ASSERT_ANY_THROW(TRectMatrix<int> m(0, 3));
+	ASSERT_ANY_THROW(TRectMatrix<int> m(3, 0));
+	ASSERT_ANY_THROW(TRectMatrix<int> m(MAX_VECTOR_SIZE, 2));
+}
+
+TEST(TRectMatrix, throws_when_index_is_out_of_range)
+{
+	TRectMatrix<int> m(2, 5);
+	ASSERT_NO_THROW(m.at(1).at(4));
+	ASSERT_ANY_THROW(m.at(2));
+	ASSERT_ANY_THROW(m.at(1).at(5));
+}
+
+TEST(TRectMatrix, can_multiply_rect_matrices)
+{
+	TRectMatrix<int> a(2, 3), b(3, 2), res(2, 2);
+	int k = 1;
+	for (size_t i = 0; i < 2; i++)
+		for (size_t j = 0; j < 3; j++)
+		{
+			a[i][j] = k;
+			b[j][i] = k++;
+		}
+	res[0][0] = 14;
+	res[0][1] = 32;
+	res[1][0] = 32;
+	res[1][1] = 77;
+	EXPECT_EQ(res, a * b);
+	ASSERT_ANY_THROW(a * a);
+}
+
+TEST(TRectMatrix, blocked_rect_product_equals_naive)
+{
+	const size_t m = 70, n = 45, k = 133;
+	TRectMatrix<double> a(m, k), b(k, n);
+	for (size_t i = 0; i < m; i++)
+		for (size_t p = 0; p < k; p++)
+			a[i][p] = double((i * 3 + p) % 7) - 3;
+	for (size_t p = 0; p < k; p++)
+		for (size_t j = 0; j < n; j++)
+			b[p][j] = double((p + j * 5) % 11) - 5;
+	TRectMatrix<double> c = a * b;
+	bool ok = c.rows() == m && c.cols() == n;
+	for (size_t i = 0; i < m && ok; i++)
+		for (size_t j = 0; j < n; j++)
+		{
+			double s = 0;
+			for (size_t p = 0; p < k; p++)
+				s += a[i][p] * b[p][j];
+			ok = ok && s == c[i][j];
+		}
+	EXPECT_TRUE(ok);
+}
+
+TEST(TRectMatrix, can_multiply_rect_matrix_by_vector)
+{
+	TRectMatrix<int> a(3, 2);
+	TDynamicVector<int> v(2), res(3);
+	for (size_t i = 0; i < 3; i++)
+	{
+		a[i][0] = int(i);
+		a[i][1] = 1;
+		res[i] = int(i) * 2 + 3;
+	}
+	v[0] = 2;
+	v[1] = 3;
+	EXPECT_EQ(res, a * v);
+	ASSERT_ANY_THROW(a * res);
+}
+
+TEST(TRectMatrix, can_multiply_with_square_matrix)
+{
+	TRectMatrix<int> a(2, 3, 1);
+	TDynamicMatrix<int> s(3, 2), e(2);
+	e[0][0] = 1;
+	e[1][1] = 1;
+	EXPECT_EQ(TRectMatrix<int>(2, 3, 6), a * s);
+	TRectMatrix<int> b = e * a;
+	EXPECT_EQ(a, b);
+	ASSERT_ANY_THROW(s * a);
+}
+
+TEST(TRectMatrix, can_convert_to_and_from_square_matrix)
+{
+	TDynamicMatrix<int> s(3, 4);
+	TRectMatrix<int> r(s);
+	EXPECT_EQ(3, r.rows());
+	EXPECT_EQ(3, r.cols());
+	EXPECT_EQ(s, TDynamicMatrix<int>(r));
+	ASSERT_ANY_THROW(TDynamicMatrix<int>(TRectMatrix<int>(2, 3)));
+}
+
+TEST(TRectMatrix, can_transpose_and_get_column)
+{
+	TRectMatrix<int> a(2, 3), t(3, 2);
+	for (size_t i = 0; i < 2; i++)
+		for (size_t j = 0; j < 3; j++)
+			a[i][j] = int(i * 3 + j);
+	a.Transposed(t);
+	EXPECT_EQ(TDynamicVector<int>(t[2]), a.Column(2));
+	ASSERT_ANY_THROW(a.Transposed(a));
+}
+
+TEST(TRectMatrix, can_use_expressions)
+{
+	TRectMatrix<int> a(2, 6, 3), b(2, 6, 1), c(3, 4, 1);
+	TRectMatrix<int> m = a * 2 - b;
+	EXPECT_EQ(TRectMatrix<int>(2, 6, 5), m);
+	m += b;
+	EXPECT_EQ(TRectMatrix<int>(2, 6, 6), m);
+	ASSERT_ANY_THROW(a + c);
+}
+
+TEST(TRectMatrix, results_keep_allocator_of_left_operand)
+{
+	typedef TTaggedAllocator<int> TTagged;
+	TDynamicMatrix<int, TTagged> d(3, 2, TTagged(1));
+	TRectMatrix<int, TTagged> a(d), b(3, 4, 1, TTagged(2));
+	TDynamicVector<int, TTagged> v(3, 1, TTagged(3));
+	TDynamicMatrix<int, TTagged> back(a);
+	TRectMatrix<int, TTagged> ab = a * b, da = d * a, ad = a * d, sum = a + a;
+	EXPECT_EQ(1, a.get_allocator().tag);
+	EXPECT_EQ(1, back.get_allocator().tag);
+	EXPECT_EQ(1, ab.get_allocator().tag);
+	EXPECT_EQ(1, da.get_allocator().tag);
+	EXPECT_EQ(1, ad.get_allocator().tag);
+	EXPECT_EQ(1, sum.get_allocator().tag);
+	EXPECT_EQ(1, (a * v).get_allocator().tag);
+	EXPECT_EQ(1, a.Column(0).get_allocator().tag);
+	EXPECT_EQ(d, back);
+}
@@ -0,0 +1,138 @@
+#include "TSparseMatrix.h"
+#include "test_alloc.h"
+
+#include <gtest.h>
+
+TEST(TSparseMatrix, can_create_sparse_matrix)
+{
+	ASSERT_NO_THROW(TSparseMatrix<int> m(10));
+	TSparseMatrix<int> m(10);
+	EXPECT_EQ(0, m.nnz());
+	EXPECT_EQ(0, m(3, 4));
+}
+
+TEST(TSparseMatrix, cant_create_sparse_matrix_with_zero_size)
+{
+	ASSERT_ANY_THROW(TSparseMatrix<int> m(0));
+}
+
+TEST(TSparseMatrix, conversion_from_dense_keeps_only_nonzeros)
+{
+	TDynamicMatrix<int> d(4);
+	d[0][1] = 5;
+	d[2][2] = -3;
+	d[3][0] = 1;
+	TSparseMatrix<int> m(d);
+	EXPECT_EQ(3, m.nnz());
+	EXPECT_EQ(5, m(0, 1));
+	EXPECT_EQ(-3, m(2, 2));
+	EXPECT_EQ(0, m(1, 1));
+	EXPECT_EQ(d, TDynamicMatrix<int>(m));
+}
+
+TEST(TSparseMatrix, conversion_from_dense_drops_values_below_tolerance)
+{
+	TDynamicMatrix<double> d(3);
+	d[0][0] = 1.0;
+	d[0][2] = 1e-12;
+	d[1][1] = -1e-9;
+	d[2][1] = -2.0;
+	TSparseMatrix<double> m(d, 1e-8);
+	EXPECT_EQ(2, m.nnz());
+	EXPECT_EQ(0.0, m(0, 2));
+	EXPECT_EQ(0.0, m(1, 1));
+	EXPECT_EQ(-2.0, m(2, 1));
+}
+
+TEST(TSparseMatrix, triplets_are_sorted_and_duplicates_summed)
+{
+	TDynamicVector<size_t> r(5), c(5);
+	TDynamicVector<int> v(5);
+	size_t rr[] = { 2, 0, 2, 0, 2 }, cc[] = { 3, 1, 0, 1, 3 };
+	int vv[] = { 1, 2, 3, 4, 5 };
+	for (size_t k = 0; k < 5; k++)
+	{
+		r[k] = rr[k];
+		c[k] = cc[k];
+		v[k] = vv[k];
+	}
+	TSparseMatrix<int> m(4, r, c, v);
+	EXPECT_EQ(3, m.nnz());
+	EXPECT_EQ(6, m(0, 1));
+	EXPECT_EQ(3, m(2, 0));
+	EXPECT_EQ(6, m(2, 3));
+
+	TDynamicMatrix<int> d(4);
+	d[0][1] = 6;
+	d[2][0] = 3;
+	d[2][3] = 6;
+	EXPECT_EQ(TSparseMatrix<int>(d), m);
+}
+
+TEST(TSparseMatrix, throws_when_index_is_out_of_range)
+{
+	TSparseMatrix<int> m(3);
+	ASSERT_ANY_THROW(m.at(3, 0));
+	ASSERT_ANY_THROW(m.at(0, 3));
+	TDynamicVector<size_t> r(1, 3), c(1, 0);
+	TDynamicVector<int> v(1, 1);
+	ASSERT_ANY_THROW(TSparseMatrix<int> w(3, r, c, v));
+}
+
+TEST(TSparseMatrix, sparse_matrix_vector_product_equals_dense)
+{
+	const size_t size = 300;
+	TDynamicMatrix<int> d(size);
+	TDynamicVector<int> v(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		v[i] = int(i % 7) - 3;
+		for (size_t j = 0; j < size; j++)
+			if ((i * 31 + j * 17) % 23 == 0)
+				d[i][j] = int(i + 2 * j) % 9 - 4;
+	}
+	TSparseMatrix<int> m(d);
+	EXPECT_EQ(d * v, m * v);
+	ASSERT_ANY_THROW(m * TDynamicVector<int>(size + 1));
+}
+
+TEST(TSparseMatrix, sparse_matrix_dense_matrix_product_equals_dense)
+{
+	const size_t size = 64;
+	TDynamicMatrix<int> d(size), b(size);
+	for (size_t i = 0; i < size; i++)
+		for (size_t j = 0; j < size; j++)
+		{
+			b[i][j] = int(i * 3 + j) % 11 - 5;
+			if ((i + j * 5) % 13 == 0)
+				d[i][j] = int(i ^ j) % 7 - 3;
+		}
+	TSparseMatrix<int> m(d);
+	EXPECT_EQ(d * b, m * b);
+	ASSERT_ANY_THROW(m * TDynamicMatrix<int>(size - 1));
+}
+
+TEST(TSparseMatrix, can_compare_sparse_matrices)
+{
+	TDynamicMatrix<int> d(3);
+	d[1][2] = 4;
+	TSparseMatrix<int> m1(d), m2(d);
+	EXPECT_TRUE(m1 == m2);
+	d[0][0] = 1;
+	EXPECT_TRUE(m1 != TSparseMatrix<int>(d));
+}
+
+TEST(TSparseMatrix, results_keep_allocator_of_matrix)
+{
+	typedef TTaggedAllocator<int> TTagged;
+	TDynamicMatrix<int, TTagged> d(3, 0, TTagged(1));
+	d[0][1] = 2;
+	d[2][2] = 3;
+	TSparseMatrix<int, TTagged> m(d);
+	TDynamicMatrix<int, TTagged> dense(m);
+	EXPECT_EQ(1, m.get_allocator().tag);
+	EXPECT_EQ(1, dense.get_allocator().tag);
+	EXPECT_EQ(1, (m * TDynamicVector<int, TTagged>(3, 1, TTagged(2))).get_allocator().tag);
+	EXPECT_EQ(1, (m * TDynamicMatrix<int, TTagged>(3, 1, TTagged(2))).get_allocator().tag);
+	EXPECT_EQ(d, dense);
+}
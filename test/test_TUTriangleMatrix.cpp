@@ -230,4 +230,128 @@ TEST(TUTriangleMatrix, cant_multiply_utriangle_matrices_with_not_equal_size)
   const size_t size1 = 2, size2 = 4;
   TUTriangleMatrix<int> m1(size1), m2(size2);
   ASSERT_ANY_THROW(m1 * m2);
-}
\ No newline at end of file
+}
+TEST(TUTriangleMatrix, can_solve_utriangle_system)
+{
+  const size_t size = 3;
+  TUTriangleMatrix<int> m(size);
+  TDynamicVector<int> x(size);
+
+  m(0, 0) = 1;
+  m(0, 1) = 2;
+  m(0, 2) = 3;
+  m(1, 1) = 4;
+  m(1, 2) = 6;
+  m(2, 2) = 5;
+
+  x[0] = 1;
+  x[1] = -2;
+  x[2] = 3;
+
+  EXPECT_EQ(x, m.Solve(m * x));
+}
+
+TEST(TUTriangleMatrix, can_solve_utriangle_system_with_unit_diagonal)
+{
+  const size_t size = 3;
+  TUTriangleMatrix<int> m(size, 5);
+  TDynamicVector<int> b(size), x(size);
+
+  b[0] = 36;
+  b[1] = 7;
+  b[2] = 1;
+
+  x[0] = 21;
+  x[1] = 2;
+  x[2] = 1;
+
+  EXPECT_EQ(x, m.Solve(b, true));
+}
+
+TEST(TUTriangleMatrix, can_solve_utriangle_system_with_matrix_right_side)
+{
+  const size_t size = 3;
+  TUTriangleMatrix<int> m(size);
+  TDynamicMatrix<int> x(size), b(size);
+
+  m(0, 0) = 1;
+  m(0, 1) = 2;
+  m(0, 2) = 3;
+  m(1, 1) = 4;
+  m(1, 2) = 6;
+  m(2, 2) = 5;
+
+  int k = 1;
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      x[i][j] = k++;
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      for (size_t l = i; l < size; l++)
+        b[i][j] += m(i, l) * x[l][j];
+
+  EXPECT_EQ(x, m.Solve(b));
+}
+
+TEST(TUTriangleMatrix, cant_solve_utriangle_system_with_zero_on_diagonal)
+{
+  TUTriangleMatrix<int> m(3, 1);
+  TDynamicVector<int> b(3, 1);
+  m(1, 1) = 0;
+  ASSERT_ANY_THROW(m.Solve(b));
+}
+
+TEST(TUTriangleMatrix, throws_when_get_element_below_diagonal)
+{
+  TUTriangleMatrix<int> m(4);
+  ASSERT_ANY_THROW(m.at(2, 1));
+}
+
+TEST(TUTriangleMatrix, rows_are_packed_in_one_buffer)
+{
+  TUTriangleMatrix<int> m(4);
+  EXPECT_EQ(&m(0, 3) + 1, &m(1, 1));
+  EXPECT_EQ(&m(2, 3) + 1, &m(3, 3));
+}
+
+TEST(TUTriangleMatrix, can_evaluate_chained_expression)
+{
+	TUTriangleMatrix<int> a(3, 2), b(3, 1);
+	TUTriangleMatrix<int> m = -(a * 2 - b) + a;
+	EXPECT_EQ(TUTriangleMatrix<int>(3, -1), m);
+}
+
+TEST(TUTriangleMatrix, can_multiply_and_solve_expressions)
+{
+	TUTriangleMatrix<double> a(3, 1.0), b(3, 2.0);
+	TDynamicVector<double> v(3, 1.0);
+	TUTriangleMatrix<double> sum = a + b;
+	EXPECT_EQ(3, (a + b).size());
+	EXPECT_EQ(sum * v, (a + b) * v);
+	EXPECT_EQ(sum * a, (a + b) * a);
+	EXPECT_EQ(sum.Solve(v), (a + b).Solve(v));
+}
+
+TEST(TUTriangleMatrix, can_use_compound_assignment)
+{
+	TUTriangleMatrix<int> a(3, 2), b(3, 1);
+	a += b;
+	a *= 4;
+	a -= b * 2;
+	a /= 5;
+	EXPECT_EQ(TUTriangleMatrix<int>(3, 2), a);
+}
+
+TEST(TUTriangleMatrix, multiply_assign_equals_product)
+{
+	const size_t size = 5;
+	TUTriangleMatrix<int> a(size, 1), b(size, 2);
+	a(2, 2) = 3;
+	b(size - 1, size - 1) = -1;
+	TUTriangleMatrix<int> ab = a * b, aa = a * a;
+	TUTriangleMatrix<int> c(a);
+	c *= b;
+	EXPECT_EQ(ab, c);
+	a *= a;
+	EXPECT_EQ(aa, a);
+}
@@ -0,0 +1,23 @@
+#ifndef __TestAlloc_H__
+#define __TestAlloc_H__
+
+#include "talloc.h"
+
+// stateful allocator: the tag tells which instance a container holds
+template<typename T>
+struct TTaggedAllocator : TAlignedAllocator<T>
+{
+  template<typename U>
+  struct rebind { typedef TTaggedAllocator<U> other; };
+
+  int tag;
+  explicit TTaggedAllocator(int t = 0) : tag(t) {}
+  template<typename U>
+  TTaggedAllocator(const TTaggedAllocator<U>& a) : tag(a.tag) {}
+  template<typename U>
+  bool operator==(const TTaggedAllocator<U>& a) const { return tag == a.tag; }
+  template<typename U>
+  bool operator!=(const TTaggedAllocator<U>& a) const { return tag != a.tag; }
+};
+
+#endif
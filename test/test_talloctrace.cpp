@@ -0,0 +1,115 @@
+#include "talloctrace.h"
+#include "tmatrix.h"
+#include "TUTriangleMatrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+#ifdef MP2_ALLOC_TRACE
+const bool ALLOC_TRACE = true;
+#else
+const bool ALLOC_TRACE = false;
+#endif
+
+static TAllocSiteStats FindSite(const char* name)
+{
+  for (const TAllocSiteStats& r : AllocTraceResults())
+    if (r.site == name)
+      return r;
+  return TAllocSiteStats();
+}
+
+TEST(AllocTrace, attributes_allocations_to_operator)
+{
+  const size_t n = 10;
+  TDynamicMatrix<double> a(n, 1.0);
+  AllocTraceReset();
+  {
+    TDynamicMatrix<double> c = a * a;
+    TDynamicVector<double> v(n, 1.0);
+    TDynamicVector<double> r = a * v;
+  }
+  const TAllocSiteStats mul = FindSite("matrix.mul_matrix");
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, mul.allocs);
+  EXPECT_EQ(ALLOC_TRACE ? n * n * sizeof(double) : 0, mul.bytes);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("matrix.mul_vector").allocs);
+}
+
+TEST(AllocTrace, constructors_outside_operators_use_their_own_site)
+{
+  AllocTraceReset();
+  TDynamicVector<int> v(5, 1);
+  TDynamicVector<int> w(v);
+  TDynamicVector<int> s = v + w;
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("vector.ctor").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("vector.copy").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("expr.construct").allocs);
+}
+
+TEST(AllocTrace, matrix_expressions_use_matrix_sites)
+{
+  TDynamicMatrix<double> a(4, 1.0), b(4, 2.0);
+  TUTriangleMatrix<double> u(4, 1.0);
+  AllocTraceReset();
+  TDynamicMatrix<double> c = a + b;
+  c = -a * 2.0;
+  TDynamicMatrix<double> d(2);
+  d = a - b;
+  TUTriangleMatrix<double> w = u / 2.0;
+  TDynamicVector<double> v = a[0] + b[0];
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("matrix.expr_construct").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("matrix.expr_assign").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("utmatrix.expr_construct").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("expr.construct").allocs);
+  EXPECT_EQ(0, FindSite("expr.assign").allocs);
+}
+
+TEST(AllocTrace, innermost_site_wins)
+{
+  TDynamicMatrix<double> a(4);
+  for (size_t i = 0; i < 4; i++)
+    a[i][i] = 2.0;
+  AllocTraceReset();
+  EXPECT_EQ(8.0, a.Minor(0, 0));
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("matrix.cofactor").allocs);
+  EXPECT_EQ(ALLOC_TRACE ? 1 : 0, FindSite("matrix.det").allocs);
+}
+
+TEST(AllocTrace, tracks_frees_and_live_bytes)
+{
+  AllocTraceReset();
+  {
+    TUTriangleMatrix<double> u(6, 1.0);
+    TUTriangleMatrix<double> p = u * u;
+    EXPECT_EQ(ALLOC_TRACE ? 21 * sizeof(double) : 0, FindSite("utmatrix.mul_matrix").liveBytes);
+  }
+  const TAllocSiteStats r = FindSite("utmatrix.mul_matrix");
+  EXPECT_EQ(r.allocs, r.frees);
+  EXPECT_EQ(0, r.liveBytes);
+  EXPECT_EQ(ALLOC_TRACE ? 21 * sizeof(double) : 0, r.peakLiveBytes);
+}
+
+TEST(AllocTrace, peak_live_bytes_counts_simultaneous_buffers)
+{
+  AllocTraceReset();
+  {
+    TDynamicVector<char> a(100), b(200);
+  }
+  {
+    TDynamicVector<char> c(250);
+  }
+  EXPECT_EQ(ALLOC_TRACE ? 300 : 0, AllocTracePeakLiveBytes());
+  EXPECT_EQ(ALLOC_TRACE ? 300 : 0, FindSite("vector.ctor").peakLiveBytes);
+}
+
+TEST(AllocTrace, reset_clears_results_and_print_lists_sites)
+{
+  TDynamicVector<double> v(3, 1.0);
+  TDynamicVector<double> w = v * 2.0;
+  std::ostringstream os;
+  AllocTracePrint(os);
+  EXPECT_EQ(ALLOC_TRACE, os.str().find("expr.construct") != std::string::npos);
+  AllocTraceReset();
+  EXPECT_TRUE(AllocTraceResults().empty());
+  EXPECT_EQ(0, AllocTracePeakLiveBytes());
+}
@@ -1,4 +1,5 @@
 #include "tmatrix.h"
+#include "test_alloc.h"
 
 #include <gtest.h>
 
@@ -335,6 +336,42 @@ TEST(TDynamicMatrix, can_transpose)
   EXPECT_EQ(true, m1 == m2);
 }
 
+TEST(TDynamicMatrix, transpose_of_odd_size_matrix_is_correct)
+{
+  const size_t size = 301;
+  TDynamicMatrix<int> m(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      m[i][j] = int(i * size + j);
+  m.Transpose();
+  bool ok = true;
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      ok = ok && m[i][j] == int(j * size + i);
+  EXPECT_TRUE(ok);
+}
+
+TEST(TDynamicMatrix, can_transpose_into_destination)
+{
+  const size_t size = 77;
+  TDynamicMatrix<int> m(size), t(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      m[i][j] = int(i * 3 + j * 5);
+  m.Transposed(t);
+  TDynamicMatrix<int> expected(m);
+  expected.Transpose();
+  EXPECT_EQ(expected, t);
+  m.Transposed(m);
+  EXPECT_EQ(expected, m);
+}
+
+TEST(TDynamicMatrix, cant_transpose_into_destination_with_not_equal_size)
+{
+  TDynamicMatrix<int> m(3), t(4);
+  ASSERT_ANY_THROW(m.Transposed(t));
+}
+
 TEST(TDynamicMatrix, can_get_invertible_matrix_with_non_zero_determinant)
 {
   TDynamicMatrix<int> m1(3), m2(3);
@@ -467,4 +504,474 @@ TEST(TDynamicMatrix, self_division_is_identity_matrix)
   E[2][2] = 1;
 
   EXPECT_EQ(E, m / m);
-}
\ No newline at end of file
+}
+TEST(TDynamicMatrix, rows_are_stored_in_one_contiguous_buffer)
+{
+  TDynamicMatrix<int> m(4);
+  for (size_t i = 1; i < 4; i++)
+    EXPECT_EQ(m[i - 1].data() + 4, m[i].data());
+}
+
+TEST(TDynamicMatrix, can_assign_row_from_vector)
+{
+  TDynamicMatrix<int> m(3);
+  TDynamicVector<int> v(3, 7);
+  m[1] = v;
+  EXPECT_EQ(v, TDynamicVector<int>(m[1]));
+  EXPECT_EQ(0, m[0][0]);
+}
+
+TEST(TDynamicMatrix, throws_when_assign_row_from_vector_with_not_equal_size)
+{
+  TDynamicMatrix<int> m(3);
+  TDynamicVector<int> v(4);
+  ASSERT_ANY_THROW(m[1] = v);
+}
+
+TEST(TDynamicMatrix, blocked_product_of_large_matrices_matches_naive_one)
+{
+  const size_t size = 131;
+  TDynamicMatrix<int> m1(size), m2(size), res(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+    {
+      m1[i][j] = int((i * 7 + j * 3) % 11) - 5;
+      m2[i][j] = int((i * 5 + j * 13) % 17) - 8;
+    }
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      for (size_t k = 0; k < size; k++)
+        res[i][j] += m1[i][k] * m2[k][j];
+  EXPECT_EQ(res, m1 * m2);
+}
+
+TEST(TDynamicMatrix, can_find_determinant_with_zero_leading_element)
+{
+  TDynamicMatrix<int> m(3);
+
+  m[0][0] = 0;
+  m[0][1] = 2;
+  m[0][2] = 1;
+
+  m[1][0] = 1;
+  m[1][1] = 0;
+  m[1][2] = 3;
+
+  m[2][0] = 4;
+  m[2][1] = 1;
+  m[2][2] = 0;
+  EXPECT_EQ(25, m.Det());
+}
+
+TEST(TDynamicMatrix, determinant_of_singular_matrix_is_zero)
+{
+  TDynamicMatrix<int> m(4);
+  for (size_t i = 0; i < 4; i++)
+    for (size_t j = 0; j < 4; j++)
+      m[i][j] = int(i + j);
+  EXPECT_EQ(0, m.Det());
+}
+
+TEST(TDynamicMatrix, can_find_determinant_of_large_integer_matrix_exactly)
+{
+  const size_t size = 20;
+  TDynamicMatrix<long long> m(size, 1);
+  for (size_t i = 0; i < size; i++)
+    m[i][i] = 3;
+  // det(2E + J) = 2^(n-1) * (2 + n)
+  EXPECT_EQ((1LL << (size - 1)) * (2 + size), m.Det());
+}
+
+TEST(TDynamicMatrix, can_find_determinant_of_large_floating_point_matrix)
+{
+  const size_t size = 100;
+  TDynamicMatrix<double> m(size, 0.5);
+  for (size_t i = 0; i < size; i++)
+    m[i][i] = 1.5;
+  // det(E + J / 2) = 1 + n / 2
+  EXPECT_NEAR(51.0, m.Det(), 1e-9);
+}
+
+TEST(TDynamicMatrix, can_get_invertible_matrix_of_even_size)
+{
+  TDynamicMatrix<int> m(4), E(4);
+  for (size_t i = 0; i < 4; i++)
+  {
+    m[i][i] = 1;
+    E[i][i] = 1;
+  }
+  m[0][1] = 2;
+  m[1][3] = -3;
+  m[2][0] = 1;
+  EXPECT_EQ(E, m * m.Invertible());
+}
+
+TEST(TDynamicMatrix, can_get_invertible_floating_point_matrix)
+{
+  const size_t size = 30;
+  TDynamicMatrix<double> m(size, 0.5);
+  for (size_t i = 0; i < size; i++)
+    m[i][i] = double(i + 2);
+  TDynamicMatrix<double> p = m * m.Invertible();
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      EXPECT_NEAR(i == j ? 1.0 : 0.0, p[i][j], 1e-12);
+}
+
+TEST(TDynamicMatrix, can_solve_system_with_vector_right_side)
+{
+  TDynamicMatrix<double> m(3);
+  TDynamicVector<double> x(3), b(3);
+
+  m[0][0] = 0;
+  m[0][1] = 2;
+  m[0][2] = 1;
+
+  m[1][0] = 1;
+  m[1][1] = 0;
+  m[1][2] = 3;
+
+  m[2][0] = 4;
+  m[2][1] = 1;
+  m[2][2] = 0;
+
+  x[0] = 1;
+  x[1] = -2;
+  x[2] = 3;
+  b = m * x;
+
+  TDynamicVector<double> res = Solve(m, b);
+  for (size_t i = 0; i < 3; i++)
+    EXPECT_NEAR(x[i], res[i], 1e-12);
+}
+
+TEST(TDynamicMatrix, can_solve_integer_system_exactly)
+{
+  TDynamicMatrix<int> m(3);
+  TDynamicVector<int> x(3);
+
+  m[0][0] = 2;
+  m[0][1] = 5;
+  m[0][2] = 7;
+
+  m[1][0] = 6;
+  m[1][1] = 3;
+  m[1][2] = 4;
+
+  m[2][0] = 5;
+  m[2][1] = -2;
+  m[2][2] = -3;
+
+  x[0] = 4;
+  x[1] = -1;
+  x[2] = 2;
+
+  EXPECT_EQ(x, Solve(m, m * x));
+}
+
+TEST(TDynamicMatrix, can_solve_system_with_matrix_right_side)
+{
+  TDynamicMatrix<int> m(3), X(3);
+  int k = 1;
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+      X[i][j] = k++;
+  m[0][0] = 2;
+  m[0][1] = 5;
+  m[0][2] = 7;
+
+  m[1][0] = 6;
+  m[1][1] = 3;
+  m[1][2] = 4;
+
+  m[2][0] = 5;
+  m[2][1] = -2;
+  m[2][2] = -3;
+
+  EXPECT_EQ(X, Solve(m, m * X));
+}
+
+TEST(TDynamicMatrix, cant_solve_system_with_singular_matrix)
+{
+  TDynamicMatrix<double> m(3, 1.0);
+  TDynamicVector<double> b(3, 1.0);
+  ASSERT_ANY_THROW(Solve(m, b));
+}
+
+TEST(TDynamicMatrix, cant_solve_system_with_not_equal_size)
+{
+  TDynamicMatrix<double> m(3);
+  TDynamicVector<double> b(4);
+  ASSERT_ANY_THROW(Solve(m, b));
+}
+
+TEST(TDynamicMatrix, can_evaluate_chained_expression)
+{
+  const size_t size = 5;
+  TDynamicMatrix<int> a(size), b(size), res(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+    {
+      a[i][j] = int(i * size + j);
+      b[i][j] = int(i) - int(j);
+      res[i][j] = a[i][j] * 3 - (a[i][j] + b[i][j]) / 2;
+    }
+  TDynamicMatrix<int> m = a * 3 - (a + b) / 2;
+  EXPECT_EQ(res, m);
+}
+
+TEST(TDynamicMatrix, can_assign_expression_to_row)
+{
+  TDynamicMatrix<int> m(3, 1);
+  m[1] = m[0] + m[2] * 2;
+  EXPECT_EQ(TDynamicVector<int>(3, 3), m[1]);
+}
+
+TEST(TDynamicMatrix, can_multiply_matrix_by_vector_expression)
+{
+  TDynamicMatrix<int> m(3, 1);
+  TDynamicVector<int> a(3, 1), b(3, 2);
+  EXPECT_EQ(TDynamicVector<int>(3, 9), m * (a + b));
+}
+
+TEST(TDynamicMatrix, can_multiply_expressions_as_matrices)
+{
+  TDynamicMatrix<int> a(3, 1), b(3, 2), c(3, 1);
+  TDynamicVector<int> v(3, 1);
+  TDynamicMatrix<int> sum = a + b;
+  EXPECT_EQ(sum * c, (a + b) * c);
+  EXPECT_EQ(c * sum, c * (a + b));
+  EXPECT_EQ(sum * sum, (a + b) * (b + a));
+  EXPECT_EQ(TDynamicVector<int>(3, -3), (a - b) * v);
+}
+
+TEST(TDynamicMatrix, expression_indexes_like_matrix)
+{
+  TDynamicMatrix<int> a(3), b(3, 1);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < 3; j++)
+      a[i][j] = int(i * 3 + j);
+  EXPECT_EQ(3, (a + b).size());
+  EXPECT_EQ(3, (a + b)[1].size());
+  EXPECT_EQ(6, (a + b)[1][2]);
+  TDynamicVector<int> row = (a + b)[2];
+  EXPECT_EQ(a[2] + b[2], row);
+  EXPECT_EQ(2, (a * 2).at(0).at(1));
+  ASSERT_ANY_THROW((a + b).at(3));
+}
+
+TEST(TDynamicMatrix, can_call_methods_of_expression)
+{
+  TDynamicMatrix<double> a(3, 1.0), b(3);
+  for (size_t i = 0; i < 3; i++)
+    b[i][i] = 1.0;
+  TDynamicMatrix<double> sum = a + b;
+  TDynamicVector<double> v(3, 1.0);
+  EXPECT_DOUBLE_EQ(sum.Det(), (a + b).Det());
+  EXPECT_DOUBLE_EQ(sum.Minor(0, 1), (a + b).Minor(0, 1));
+  EXPECT_EQ(sum.Invertible(), (a + b).Invertible());
+  EXPECT_EQ(Solve(sum, v), Solve(a + b, v));
+  EXPECT_EQ(Solve(sum, v + v), Solve(a + b, v * 2.0));
+  EXPECT_EQ(sum / b, (a + b) / b);
+}
+
+TEST(TDynamicMatrix, can_use_compound_assignment)
+{
+  TDynamicMatrix<int> a(3, 2), b(3, 1);
+  a += b;
+  a *= 4;
+  a -= b * 2;
+  a /= 5;
+  EXPECT_EQ(TDynamicMatrix<int>(3, 2), a);
+}
+
+TEST(TDynamicMatrix, multiply_assign_equals_product)
+{
+  const size_t size = 67;
+  TDynamicMatrix<double> a(size), b(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+    {
+      a[i][j] = double((i * 7 + j) % 11) - 5;
+      b[i][j] = double((i + j * 3) % 13) - 6;
+    }
+  TDynamicMatrix<double> ab = a * b, aa = a * a;
+  TDynamicMatrix<double> c(a);
+  c *= b;
+  EXPECT_EQ(ab, c);
+  a *= a;
+  EXPECT_EQ(aa, a);
+}
+
+TEST(TDynamicMatrix, cant_multiply_assign_matrices_with_not_equal_size)
+{
+  TDynamicMatrix<int> a(3), b(4);
+  ASSERT_ANY_THROW(a *= b);
+}
+
+TEST(TDynamicMatrix, operations_with_temporary_reuse_its_memory)
+{
+  TDynamicMatrix<int> a(3, 1), b(3, 2), c(3, 1);
+  TDynamicMatrix<int> t = a * b;
+  const int* p = &t[0][0];
+  TDynamicMatrix<int> r = std::move(t) + c + c * 2;
+  EXPECT_EQ(TDynamicMatrix<int>(3, 9), r);
+  EXPECT_EQ(p, &r[0][0]);
+  EXPECT_EQ(TDynamicMatrix<int>(3, 7), c + a * b);
+}
+
+TEST(TDynamicMatrix, cant_add_temporary_with_not_equal_size)
+{
+  TDynamicMatrix<int> a(3), b(4);
+  ASSERT_ANY_THROW(a * a + b);
+  ASSERT_ANY_THROW(b + a * a);
+}
+
+TEST(TDynamicMatrix, parallel_and_serial_products_are_equal)
+{
+  const size_t size = 300;
+  TDynamicMatrix<double> a(size), b(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+    {
+      a[i][j] = double((i * 5 + j) % 17) - 8;
+      b[i][j] = double((i + j * 7) % 19) - 9;
+    }
+  const size_t threads = ParallelThreadCount();
+  GemmSetParallel(false);
+  TDynamicMatrix<double> serial = a * b;
+  GemmSetParallel(true);
+  EXPECT_EQ(4, ParallelSetThreadCount(4));
+  EXPECT_EQ(serial, a * b);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(TDynamicMatrix, parallel_transpose_det_and_invertible_match_serial)
+{
+  const size_t size = 400;
+  TDynamicMatrix<double> a(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+      a[i][j] = double((i * 13 + j * 7) % 23) - 11 + (i == j ? 300 : 0);
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(1);
+  TDynamicMatrix<double> t(a), inv = a.Invertible();
+  t.Transpose();
+  double det = a.Det();
+  ParallelSetThreadCount(4);
+  TDynamicMatrix<double> pt(a);
+  pt.Transpose();
+  EXPECT_EQ(t, pt);
+  EXPECT_EQ(det, a.Det());
+  EXPECT_EQ(inv, a.Invertible());
+  ParallelSetThreadCount(threads);
+}
+
+TEST(TDynamicMatrix, strassen_product_equals_classic_product)
+{
+  // odd sizes exercise peeling on every level of recursion
+  const size_t size = 203;
+  TDynamicMatrix<double> a(size), b(size);
+  for (size_t i = 0; i < size; i++)
+    for (size_t j = 0; j < size; j++)
+    {
+      a[i][j] = double((i * 5 + j) % 17) - 8;
+      b[i][j] = double((i + j * 7) % 19) - 9;
+    }
+  const size_t cutoff = GemmStrassenCutoff();
+  GemmSetStrassenCutoff(24);
+  TDynamicMatrix<double> classic = a * b;
+  GemmSetStrassen(true);
+  EXPECT_EQ(classic, a * b);
+  GemmSetStrassen(false);
+  GemmSetStrassenCutoff(cutoff);
+}
+
+TEST(TDynamicMatrix, strassen_is_off_by_default)
+{
+  EXPECT_FALSE(GemmStrassenEnabled());
+}
+
+TEST(TDynamicMatrix, strassen_handles_rectangular_blocks)
+{
+  const size_t M = 45, N = 38, K = 51;
+  TDynamicVector<double> a(M * K), b(K * N), c1(M * N, 1.0), c2(M * N, 1.0);
+  for (size_t i = 0; i < M * K; i++)
+    a[i] = double(i % 13) - 6;
+  for (size_t i = 0; i < K * N; i++)
+    b[i] = double(i % 11) - 5;
+  GemmClassic(M, N, K, &a[0], K, &b[0], N, &c1[0], N);
+  GemmStrassen(M, N, K, &a[0], K, &b[0], N, &c2[0], N, 4);
+  EXPECT_EQ(c1, c2);
+}
+
+TEST(TDynamicMatrix, strassen_cutoff_is_at_least_two)
+{
+  const size_t cutoff = GemmStrassenCutoff();
+  GemmSetStrassenCutoff(0);
+  EXPECT_EQ(2, GemmStrassenCutoff());
+  GemmSetStrassenCutoff(cutoff);
+  EXPECT_EQ(cutoff, GemmStrassenCutoff());
+}
+
+TEST(TDynamicMatrix, allocator_is_threaded_through_matrix_operations)
+{
+  typedef TAlignedAllocator<double, 256> TAlloc;
+  TDynamicMatrix<double, TAlloc> a(5, 1.0);
+  TDynamicMatrix<double, TAlloc> b = a * a + a;
+  TDynamicVector<double, TAlloc> v(5, 1.0);
+  TDynamicVector<double, TAlloc> r = b * v;
+  TDynamicMatrix<double, TAlloc> expected(5, 6.0);
+  EXPECT_EQ(expected, b);
+  EXPECT_EQ(30.0, r[0]);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&b[0][0]) % 256);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&r[0]) % 256);
+}
+
+TEST(TDynamicMatrix, gemm_can_overwrite_uninitialized_result)
+{
+  for (size_t size : { 5, 70 })
+  {
+    TDynamicMatrix<double> a(size), b(size);
+    for (size_t i = 0; i < size; i++)
+      for (size_t j = 0; j < size; j++)
+      {
+        a[i][j] = double((i * 3 + j) % 7) - 3;
+        b[i][j] = double((i + j * 5) % 11) - 5;
+      }
+    TDynamicMatrix<double> expected(size), c(size, 1e300);
+    Gemm(size, size, size, &a[0][0], size, &b[0][0], size, &expected[0][0], size);
+    Gemm(size, size, size, &a[0][0], size, &b[0][0], size, &c[0][0], size, false);
+    EXPECT_EQ(expected, c);
+    const size_t cutoff = GemmStrassenCutoff();
+    GemmSetStrassen(true);
+    GemmSetStrassenCutoff(4);
+    TDynamicMatrix<double> d(size, 1e300);
+    Gemm(size, size, size, &a[0][0], size, &b[0][0], size, &d[0][0], size, false);
+    GemmSetStrassenCutoff(cutoff);
+    GemmSetStrassen(false);
+    EXPECT_EQ(expected, d);
+  }
+}
+
+TEST(TDynamicMatrix, results_keep_allocator_of_left_operand)
+{
+  typedef TTaggedAllocator<double> TTagged;
+  TDynamicMatrix<double, TTagged> a(3, 0.0, TTagged(1)), b(3, 1.0, TTagged(2));
+  TDynamicVector<double, TTagged> v(3, 1.0, TTagged(3));
+  for (size_t i = 0; i < 3; i++)
+    a[i][i] = 2;
+  EXPECT_EQ(1, a.get_allocator().tag);
+  EXPECT_EQ(1, (a * b).get_allocator().tag);
+  EXPECT_EQ(1, (a * v).get_allocator().tag);
+  EXPECT_EQ(1, Solve(a, v).get_allocator().tag);
+  EXPECT_EQ(1, Solve(a, b).get_allocator().tag);
+  TDynamicMatrix<double, TTagged> sum = b + a * 2.0;
+  EXPECT_EQ(2, sum.get_allocator().tag);
+  // the copy keeps the allocator, the row view has none to give
+  TDynamicMatrix<double, TTagged> c(a);
+  EXPECT_EQ(1, c.get_allocator().tag);
+  TDynamicVector<double, TTagged> r = a[1];
+  EXPECT_EQ(0, r.get_allocator().tag);
+  EXPECT_EQ(2, r[1]);
+}
@@ -0,0 +1,156 @@
+#include "tparallel.h"
+#include "tvector.h"
+
+#include <gtest.h>
+#include <atomic>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+TEST(Parallel, can_set_thread_count)
+{
+  const size_t threads = ParallelThreadCount();
+  EXPECT_EQ(3, ParallelSetThreadCount(3));
+  EXPECT_EQ(3, ParallelThreadCount());
+  EXPECT_LE(1, ParallelSetThreadCount(0));
+  ParallelSetThreadCount(threads);
+}
+
+#if defined(__linux__)
+TEST(Parallel, pinning_leaves_caller_affinity_unchanged)
+{
+  const size_t threads = ParallelThreadCount();
+  cpu_set_t before, after;
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(before), &before));
+  EXPECT_EQ(2, ParallelSetThreadCount(2, true));
+  ASSERT_EQ(0, sched_getaffinity(0, sizeof(after), &after));
+  EXPECT_TRUE(CPU_EQUAL(&before, &after));
+  ParallelSetThreadCount(threads);
+}
+#endif
+
+TEST(Parallel, parallel_for_calls_each_index_once)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(3);
+  TDynamicVector<int> calls(1000, 0);
+  ParallelFor(calls.size(), [&](size_t i) { calls[i] = calls[i] + 1; });
+  EXPECT_EQ(TDynamicVector<int>(1000, 1), calls);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Parallel, parallel_range_covers_range_with_chunks_not_less_than_grain)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  const size_t n = 10007, grain = 100;
+  TDynamicVector<int> calls(n, 0);
+  std::atomic<size_t> small(0);
+  ParallelRange(n, grain, [&](size_t begin, size_t end)
+  {
+    if (end - begin < grain / 2)
+      small++;
+    for (size_t i = begin; i < end; i++)
+      calls[i] = calls[i] + 1;
+  });
+  EXPECT_EQ(TDynamicVector<int>(n, 1), calls);
+  EXPECT_EQ(0, small.load());
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Parallel, can_call_parallel_range_from_parallel_range)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  const size_t n = 64;
+  TDynamicVector<int> calls(n * n, 0);
+  ParallelFor(n, [&](size_t i)
+  {
+    ParallelRange(n, 4, [&](size_t begin, size_t end)
+    {
+      for (size_t j = begin; j < end; j++)
+        calls[i * n + j] = calls[i * n + j] + 1;
+    });
+  });
+  EXPECT_EQ(TDynamicVector<int>(n * n, 1), calls);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Parallel, small_tasks_stay_serial)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  size_t chunks = 0;
+  ParallelChunks(1000, 1, [&](size_t begin, size_t end)
+  {
+    chunks++;
+    EXPECT_EQ(0, begin);
+    EXPECT_EQ(1000, end);
+  });
+  EXPECT_EQ(1, chunks);
+  EXPECT_LE(PARALLEL_MIN_WORK, ParallelGrain(1 << 20));
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Parallel, exception_from_chunk_reaches_caller)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  std::atomic<size_t> done(0);
+  EXPECT_THROW(ParallelRange(10000, 10, [&](size_t begin, size_t end)
+  {
+    if (begin <= 5000 && 5000 < end)
+      throw std::runtime_error("chunk failed");
+    done += end - begin;
+  }), std::runtime_error);
+  EXPECT_GT(10000u, done.load());
+  // the pool is still usable
+  TDynamicVector<int> calls(1000, 0);
+  ParallelFor(calls.size(), [&](size_t i) { calls[i] = calls[i] + 1; });
+  EXPECT_EQ(TDynamicVector<int>(1000, 1), calls);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Parallel, exception_from_nested_range_reaches_caller)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  EXPECT_THROW(ParallelFor(16, [&](size_t i)
+  {
+    ParallelRange(64, 4, [&](size_t begin, size_t)
+    {
+      if (i == 7 && begin == 0)
+        throw std::runtime_error("nested chunk failed");
+    });
+  }), std::runtime_error);
+  ParallelSetThreadCount(threads);
+}
+
+// element whose addition throws for one marked value
+struct TThrowingSum
+{
+  int v;
+  TThrowingSum(int x = 0) : v(x) {}
+  TThrowingSum operator+(const TThrowingSum& x) const
+  {
+    if (v < 0)
+      throw std::domain_error("bad element");
+    return TThrowingSum(v + x.v);
+  }
+};
+
+TEST(Parallel, exception_from_element_operation_leaves_expression)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  const size_t n = 4 * PARALLEL_MIN_WORK;
+  TDynamicVector<TThrowingSum> a(n, TThrowingSum(1)), b(n, TThrowingSum(2)), c(n);
+  a[n / 2] = TThrowingSum(-1);
+  EXPECT_THROW(c = a + b, std::domain_error);
+  a[n / 2] = TThrowingSum(1);
+  c = a + b;
+  EXPECT_EQ(3, c[n - 1].v);
+  ParallelSetThreadCount(threads);
+}
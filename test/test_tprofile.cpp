@@ -0,0 +1,100 @@
+#include "tprofile.h"
+#include "tmatrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+#ifdef MP2_PROFILE
+const bool PROFILE_REGIONS = true;
+#else
+const bool PROFILE_REGIONS = false;
+#endif
+
+static const TProfileRecord* FindRecord(const std::vector<TProfileRecord>& records, const char* name)
+{
+  for (const TProfileRecord& r : records)
+    if (r.name == name)
+      return &r;
+  return nullptr;
+}
+
+TEST(Profile, is_disabled_by_default_and_records_nothing)
+{
+  EXPECT_FALSE(ProfileEnabled());
+  ProfileReset();
+  TDynamicMatrix<double> a(8, 1.0);
+  TDynamicMatrix<double> c = a * a;
+  EXPECT_TRUE(ProfileResults().empty());
+}
+
+TEST(Profile, records_calls_of_kernel_regions)
+{
+  ProfileSetEnabled(true);
+  ProfileReset();
+  TDynamicMatrix<double> a(16, 1.0);
+  TDynamicMatrix<double> c = a * a;
+  c = c * a;
+  c.Transpose();
+  ProfileSetEnabled(false);
+  const std::vector<TProfileRecord> records = ProfileResults();
+  const TProfileRecord* gemm = FindRecord(records, "gemm");
+  const TProfileRecord* transpose = FindRecord(records, "transpose");
+  if (PROFILE_REGIONS)
+  {
+    ASSERT_NE(nullptr, gemm);
+    ASSERT_NE(nullptr, transpose);
+    EXPECT_EQ(2, gemm->calls);
+    EXPECT_EQ(1, transpose->calls);
+  }
+  else
+    EXPECT_TRUE(records.empty());
+}
+
+TEST(Profile, counters_are_zero_for_unavailable_events)
+{
+  const bool any = ProfileSetEnabled(true);
+  ProfileReset();
+  TDynamicMatrix<double> a(32, 1.0);
+  a.Det();
+  ProfileSetEnabled(false);
+  bool available = false;
+  for (int e = 0; e < PROFILE_EVENTS; e++)
+    available = available || ProfileEventAvailable(TProfileEvent(e));
+  EXPECT_EQ(any, available);
+  for (const TProfileRecord& r : ProfileResults())
+  {
+    for (int e = 0; e < PROFILE_EVENTS; e++)
+    {
+      if (!ProfileEventAvailable(TProfileEvent(e)))
+      {
+        EXPECT_EQ(0, r.events[e]);
+      }
+    }
+  }
+}
+
+TEST(Profile, reset_clears_results)
+{
+  ProfileSetEnabled(true);
+  TDynamicVector<float> v(100, 1.0f);
+  float d = v * v;
+  EXPECT_EQ(100.0f, d);
+  ProfileSetEnabled(false);
+  ProfileReset();
+  EXPECT_TRUE(ProfileResults().empty());
+}
+
+TEST(Profile, print_lists_regions)
+{
+  ProfileSetEnabled(true);
+  ProfileReset();
+  TDynamicMatrix<double> a(8, 1.0);
+  TDynamicVector<double> v(8, 1.0);
+  TDynamicVector<double> r = a * v;
+  ProfileSetEnabled(false);
+  std::ostringstream os;
+  ProfilePrint(os);
+  EXPECT_NE(std::string::npos, os.str().find("cycles"));
+  EXPECT_EQ(PROFILE_REGIONS, os.str().find("matrix.mul_vector") != std::string::npos);
+  ProfileReset();
+}
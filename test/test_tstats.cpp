@@ -0,0 +1,155 @@
+#include "tstats.h"
+#include "tmatrix.h"
+#include "tparallel.h"
+
+#include <gtest.h>
+#include <thread>
+
+// без MP2_STATS счетчики всегда нулевые
+#define EXPECT_STAT(expected, actual) EXPECT_EQ(StatsEnabled() ? uint64_t(expected) : 0, actual)
+
+TEST(Stats, reset_clears_counters)
+{
+  TDynamicVector<double> v(100, 1.0);
+  StatsReset();
+  const TOpStats s = StatsGet();
+  EXPECT_EQ(0, s.flops);
+  EXPECT_EQ(0, s.bytesRead);
+  EXPECT_EQ(0, s.bytesWritten);
+  EXPECT_EQ(0, s.allocs);
+  EXPECT_EQ(0, s.bytesAllocated);
+}
+
+TEST(Stats, vector_constructor_counts_allocation_and_writes)
+{
+  StatsReset();
+  TDynamicVector<int> v(100, 7);
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(1, s.allocs);
+  EXPECT_STAT(100 * sizeof(int), s.bytesAllocated);
+  EXPECT_STAT(100 * sizeof(int), s.bytesWritten);
+  EXPECT_STAT(0, s.flops);
+}
+
+TEST(Stats, vector_expression_counts_each_operation_once)
+{
+  const size_t n = 1000;
+  TDynamicVector<double> a(n, 1.0), b(n, 2.0), c(n, 3.0), r(n);
+  StatsReset();
+  r = a + b * 2.0 - c;
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(3 * n, s.flops);
+  EXPECT_STAT(3 * n * sizeof(double), s.bytesRead);
+  EXPECT_STAT(n * sizeof(double), s.bytesWritten);
+  EXPECT_STAT(0, s.allocs);
+}
+
+TEST(Stats, dot_product_counts_two_flops_per_element)
+{
+  const size_t n = 500;
+  TDynamicVector<float> a(n, 1.0f), b(n, 2.0f);
+  StatsReset();
+  float d = a * b;
+  EXPECT_EQ(1000.0f, d);
+  EXPECT_STAT(2 * n, StatsGet().flops);
+  EXPECT_STAT(2 * n * sizeof(float), StatsGet().bytesRead);
+}
+
+TEST(Stats, matrix_multiply_counts_gemm_flops)
+{
+  // one thread: pool workers allocate their GEMM buffers on first use,
+  // and that work is counted here too
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(1);
+  const size_t n = 40;
+  TDynamicMatrix<double> a(n, 1.0), b(n, 2.0);
+  TDynamicMatrix<double> warm = a * b;
+  StatsReset();
+  TDynamicMatrix<double> c = a * b;
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(2 * n * n * n, s.flops);
+  EXPECT_STAT(1, s.allocs);
+  EXPECT_STAT(n * n * sizeof(double), s.bytesWritten);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Stats, transpose_counts_memory_traffic_only)
+{
+  const size_t n = 30;
+  TDynamicMatrix<int> m(n, 1);
+  StatsReset();
+  m.Transpose();
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(0, s.flops);
+  EXPECT_STAT(n * n * sizeof(int), s.bytesRead);
+  EXPECT_STAT(n * n * sizeof(int), s.bytesWritten);
+}
+
+TEST(Stats, det_and_invertible_count_lu_work)
+{
+  const size_t n = 20;
+  TDynamicMatrix<double> m(n);
+  for (size_t i = 0; i < n; i++)
+    m[i][i] = 2.0;
+  StatsReset();
+  m.Det();
+  const TOpStats det = StatsGet();
+  m.Invertible();
+  const TOpStats inv = StatsGet() - det;
+  EXPECT_STAT(2 * n * n * n / 3 + n, det.flops);
+  EXPECT_STAT(1, det.allocs);
+  EXPECT_STAT(2 * n * n * n / 3 + 2 * n * n * n, inv.flops);
+  EXPECT_STAT(4, inv.allocs);
+}
+
+TEST(Stats, counters_are_thread_local)
+{
+  StatsReset();
+  std::thread t([]
+  {
+    TDynamicVector<double> a(100, 1.0), b(100, 1.0);
+    TDynamicVector<double> c = a + b;
+  });
+  t.join();
+  const TOpStats s = StatsGet();
+  EXPECT_EQ(0, s.flops);
+  EXPECT_EQ(0, s.allocs);
+}
+
+TEST(Stats, pool_work_is_counted_in_calling_thread)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  const size_t n = 10000;
+  StatsReset();
+  ParallelRange(n, 10, [](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
+    {
+      StatsCount(1, 8, 4);
+      StatsAlloc(16);
+    }
+  });
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(n, s.flops);
+  EXPECT_STAT(8 * n, s.bytesRead);
+  EXPECT_STAT(4 * n, s.bytesWritten);
+  EXPECT_STAT(n, s.allocs);
+  EXPECT_STAT(16 * n, s.bytesAllocated);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(Stats, parallel_matrix_multiply_counts_worker_allocations)
+{
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(4);
+  const size_t n = 256;
+  TDynamicMatrix<double> a(n, 1.0), b(n, 2.0);
+  StatsReset();
+  TDynamicMatrix<double> c = a * b;
+  const TOpStats s = StatsGet();
+  EXPECT_STAT(2 * n * n * n, s.flops);
+  // the result and, on workers that had none yet, GEMM pack buffers
+  EXPECT_LE(StatsEnabled() ? 1u : 0u, s.allocs);
+  ParallelSetThreadCount(threads);
+}
@@ -246,3 +246,346 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
   ASSERT_ANY_THROW(v1 * v2);
 }
 
+
+TEST(TDynamicVector, can_get_selected_simd_kernel_set)
+{
+  EXPECT_LE(SimdKernelSet(), SimdMaxKernelSet());
+  EXPECT_NE(nullptr, SimdKernelSetName());
+}
+
+TEST(TDynamicVector, all_simd_kernel_sets_give_same_results)
+{
+  const size_t size = 37;
+  TDynamicVector<int> v1(size), v2(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    v1[i] = int(i) - 10;
+    v2[i] = int(i % 7) + 1;
+  }
+  TSimdKernelSet selected = SimdKernelSet();
+  SimdSelectKernelSet(SIMD_SCALAR);
+  TDynamicVector<int> sum = v1 + v2, diff = v1 - v2, prod = v1 * 3, quot = v1 / 2, neg = -v1;
+  int dot = v1 * v2;
+  for (int s = SIMD_SSE2; s <= SimdMaxKernelSet(); s++)
+  {
+    SimdSelectKernelSet(TSimdKernelSet(s));
+    EXPECT_EQ(sum, v1 + v2);
+    EXPECT_EQ(diff, v1 - v2);
+    EXPECT_EQ(prod, v1 * 3);
+    EXPECT_EQ(quot, v1 / 2);
+    EXPECT_EQ(neg, -v1);
+    EXPECT_EQ(dot, v1 * v2);
+  }
+  SimdSelectKernelSet(selected);
+}
+
+TEST(TDynamicVector, can_evaluate_chained_expression)
+{
+  const size_t size = 21;
+  TDynamicVector<int> a(size), b(size), c(size), res(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    a[i] = int(i);
+    b[i] = 2 * int(i) + 1;
+    c[i] = int(i % 5);
+    res[i] = -(a[i] + b[i] - c[i] * 2) / 3 + 1;
+  }
+  TDynamicVector<int> v = -(a + b - c * 2) / 3 + 1;
+  EXPECT_EQ(res, v);
+  EXPECT_EQ(res, -(a + b - c * 2) / 3 + 1);
+}
+
+TEST(TDynamicVector, can_assign_expression_with_itself_as_operand)
+{
+  TDynamicVector<int> a(4, 3), b(4, 1);
+  a = a + b * 2 - a / 3;
+  EXPECT_EQ(TDynamicVector<int>(4, 4), a);
+}
+
+TEST(TDynamicVector, assign_expression_changes_size)
+{
+  TDynamicVector<int> a(5, 2), b(5, 3), v(2);
+  v = a + b;
+  EXPECT_EQ(5, v.size());
+  EXPECT_EQ(TDynamicVector<int>(5, 5), v);
+}
+
+TEST(TDynamicVector, cant_build_expression_with_not_equal_size)
+{
+  TDynamicVector<int> a(5), b(5), c(6);
+  ASSERT_ANY_THROW(a + b - c);
+}
+
+TEST(TDynamicVector, can_multiply_expressions_as_vectors)
+{
+  TDynamicVector<int> a(3, 1), b(3, 2);
+  EXPECT_EQ(27, (a + b) * (a + b));
+}
+
+TEST(TDynamicVector, can_use_compound_assignment_with_scalar)
+{
+  TDynamicVector<int> v(4, 2);
+  v += 4;
+  v *= 3;
+  v -= 2;
+  v /= 4;
+  EXPECT_EQ(TDynamicVector<int>(4, 4), v);
+}
+
+TEST(TDynamicVector, can_use_compound_assignment_with_vector)
+{
+  TDynamicVector<int> a(4, 2), b(4, 5);
+  const int* p = &a[0];
+  a += b;
+  a -= b * 2;
+  a += a;
+  EXPECT_EQ(TDynamicVector<int>(4, -6), a);
+  EXPECT_EQ(p, &a[0]);
+}
+
+TEST(TDynamicVector, cant_use_compound_assignment_with_not_equal_size)
+{
+  TDynamicVector<int> a(4), b(5);
+  ASSERT_ANY_THROW(a += b);
+}
+
+TEST(TDynamicVector, operations_with_temporary_reuse_its_memory)
+{
+  TDynamicVector<int> a(3, 1), t(3, 2);
+  const int* p = &t[0];
+  TDynamicVector<int> r = -(std::move(t) + a - a * 2) * 3 + 1;
+  EXPECT_EQ(TDynamicVector<int>(3, -2), r);
+  EXPECT_EQ(p, &r[0]);
+}
+
+TEST(TDynamicVector, operations_with_temporary_right_operand_reuse_its_memory)
+{
+  TDynamicVector<int> a(3, 5), t(3, 2);
+  const int* p = &t[0];
+  TDynamicVector<int> r = a - std::move(t);
+  EXPECT_EQ(TDynamicVector<int>(3, 3), r);
+  EXPECT_EQ(p, &r[0]);
+}
+
+TEST(TDynamicVector, expression_has_size_and_elements)
+{
+  TDynamicVector<int> a(4, 1), b(4, 2);
+  EXPECT_EQ(4, (a + b).size());
+  EXPECT_EQ(3, (a + b)[3]);
+  EXPECT_EQ(-2, (a - b * 3 / 2).at(0));
+  ASSERT_ANY_THROW((a + b).at(4));
+}
+
+TEST(TDynamicVector, parallel_and_serial_expressions_are_equal)
+{
+  const size_t size = 300001;
+  TDynamicVector<double> a(size), b(size);
+  for (size_t i = 0; i < size; i++)
+  {
+    a[i] = double(i % 101) - 50;
+    b[i] = double(i % 37) + 1;
+  }
+  const size_t threads = ParallelThreadCount();
+  ParallelSetThreadCount(1);
+  TDynamicVector<double> sum = a + b, chain = (a - b * 2) / 4 + a;
+  ParallelSetThreadCount(4);
+  EXPECT_EQ(sum, a + b);
+  EXPECT_EQ(chain, (a - b * 2) / 4 + a);
+  ParallelSetThreadCount(threads);
+}
+
+TEST(TDynamicVector, memory_is_aligned_by_default)
+{
+  TDynamicVector<char> v(3);
+  TDynamicVector<double> w(5);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&v[0]) % MEM_ALIGNMENT);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&w[0]) % MEM_ALIGNMENT);
+}
+
+// stateless allocator that counts live bytes in a shared counter
+static long long countedBytes = 0;
+
+template<typename T>
+struct TCountingAllocator
+{
+  typedef T value_type;
+  TCountingAllocator() = default;
+  template<typename U>
+  TCountingAllocator(const TCountingAllocator<U>&) {}
+  T* allocate(size_t n)
+  {
+    countedBytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n)
+  {
+    countedBytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+};
+
+TEST(TDynamicVector, memory_goes_through_custom_allocator)
+{
+  typedef TDynamicVector<int, TCountingAllocator<int>> TVector;
+  {
+    TVector a(10, 2), b(10, 3);
+    EXPECT_EQ(80, countedBytes);
+    TVector c = a + b * 2;
+    EXPECT_EQ(120, countedBytes);
+    EXPECT_EQ(TVector(10, 8), c);
+    EXPECT_EQ(80, a * TVector(10, 4));
+  }
+  EXPECT_EQ(0, countedBytes);
+}
+
+// stateful allocator: each instance draws from its own arena counter;
+// Propagate selects the propagate_on_container_* rules
+template<typename T, bool Propagate = false>
+struct TArenaAllocator
+{
+  typedef T value_type;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_copy_assignment;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_move_assignment;
+  typedef std::integral_constant<bool, Propagate> propagate_on_container_swap;
+  template<typename U>
+  struct rebind { typedef TArenaAllocator<U, Propagate> other; };
+
+  long long* arena;
+  explicit TArenaAllocator(long long* a = nullptr) : arena(a) {}
+  template<typename U>
+  TArenaAllocator(const TArenaAllocator<U, Propagate>& a) : arena(a.arena) {}
+  T* allocate(size_t n)
+  {
+    if (arena == nullptr)
+      throw std::bad_alloc();
+    *arena += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, size_t n)
+  {
+    *arena -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+  template<typename U>
+  bool operator==(const TArenaAllocator<U, Propagate>& a) const { return arena == a.arena; }
+  template<typename U>
+  bool operator!=(const TArenaAllocator<U, Propagate>& a) const { return arena != a.arena; }
+};
+
+TEST(TDynamicVector, stateless_allocator_takes_no_space)
+{
+  EXPECT_EQ(sizeof(TDynamicVector<double>), sizeof(TDynamicVector<double, TCountingAllocator<double>>));
+  EXPECT_LT(sizeof(TDynamicVector<double>), sizeof(TDynamicVector<double, TArenaAllocator<double>>));
+}
+
+TEST(TDynamicVector, stateful_allocator_is_stored_and_used)
+{
+  typedef TArenaAllocator<int> TArena;
+  typedef TDynamicVector<int, TArena> TVector;
+  long long arena1 = 0, arena2 = 0;
+  {
+    TVector a(10, 2, TArena(&arena1)), b(10, 3, TArena(&arena2));
+    EXPECT_EQ(40, arena1);
+    EXPECT_EQ(40, arena2);
+    EXPECT_EQ(TArena(&arena1), a.get_allocator());
+    TVector c(a);
+    EXPECT_EQ(TArena(&arena1), c.get_allocator());
+    EXPECT_EQ(80, arena1);
+    TVector d = a + b;
+    EXPECT_EQ(TArena(&arena1), d.get_allocator());
+    EXPECT_EQ(120, arena1);
+    EXPECT_EQ(TVector(10, 5, TArena(&arena2)), d);
+  }
+  EXPECT_EQ(0, arena1);
+  EXPECT_EQ(0, arena2);
+}
+
+TEST(TDynamicVector, non_propagating_allocator_stays_with_container)
+{
+  typedef TArenaAllocator<int> TArena;
+  typedef TDynamicVector<int, TArena> TVector;
+  long long arena1 = 0, arena2 = 0;
+  {
+    TVector a(10, 2, TArena(&arena1)), b(5, 3, TArena(&arena2));
+    b = a;
+    EXPECT_EQ(TArena(&arena2), b.get_allocator());
+    EXPECT_EQ(40, arena2);
+    EXPECT_EQ(a, b);
+    TVector c(20, 1, TArena(&arena2));
+    b = std::move(c);
+    EXPECT_EQ(TArena(&arena2), b.get_allocator());
+    EXPECT_EQ(TVector(20, 1, TArena(&arena2)), b);
+    TVector d(3, 4, TArena(&arena2));
+    a = std::move(d);
+    // unequal allocators: elements are moved into a's arena
+    EXPECT_EQ(TArena(&arena1), a.get_allocator());
+    EXPECT_EQ(12, arena1);
+    EXPECT_EQ(TVector(3, 4, TArena(&arena1)), a);
+  }
+  EXPECT_EQ(0, arena1);
+  EXPECT_EQ(0, arena2);
+}
+
+TEST(TDynamicVector, propagating_allocator_follows_contents)
+{
+  typedef TArenaAllocator<int, true> TArena;
+  typedef TDynamicVector<int, TArena> TVector;
+  long long arena1 = 0, arena2 = 0;
+  {
+    TVector a(10, 2, TArena(&arena1)), b(5, 3, TArena(&arena2));
+    b = a;
+    EXPECT_EQ(TArena(&arena1), b.get_allocator());
+    EXPECT_EQ(80, arena1);
+    EXPECT_EQ(0, arena2);
+    TVector c(4, 1, TArena(&arena2));
+    swap(a, c);
+    EXPECT_EQ(TArena(&arena2), a.get_allocator());
+    EXPECT_EQ(TArena(&arena1), c.get_allocator());
+    EXPECT_EQ(TVector(4, 1, TArena(&arena2)), a);
+    b = std::move(a);
+    EXPECT_EQ(TArena(&arena2), b.get_allocator());
+    EXPECT_EQ(16, arena2);
+    EXPECT_EQ(40, arena1);
+  }
+  EXPECT_EQ(0, arena1);
+  EXPECT_EQ(0, arena2);
+}
+
+// element type that counts how it is created
+struct TCounted
+{
+  static int defaults, copies, assigns;
+  int v;
+  TCounted() : v(0) { defaults++; }
+  TCounted(int x) : v(x) {}
+  TCounted(const TCounted& c) : v(c.v) { copies++; }
+  TCounted& operator=(const TCounted& c) { v = c.v; assigns++; return *this; }
+  TCounted operator+(const TCounted& c) const { return TCounted(v + c.v); }
+  bool operator!=(const TCounted& c) const { return v != c.v; }
+  static void Reset() { defaults = copies = assigns = 0; }
+};
+int TCounted::defaults = 0, TCounted::copies = 0, TCounted::assigns = 0;
+
+TEST(TDynamicVector, constructors_create_each_element_once)
+{
+  TCounted::Reset();
+  TDynamicVector<TCounted> a(10, TCounted(2));
+  EXPECT_EQ(0, TCounted::defaults);
+  EXPECT_EQ(10, TCounted::copies);
+  TDynamicVector<TCounted> b(a);
+  EXPECT_EQ(20, TCounted::copies);
+  TDynamicVector<TCounted> c = a + b;
+  EXPECT_EQ(0, TCounted::defaults);
+  EXPECT_EQ(0, TCounted::assigns);
+  EXPECT_EQ(4, c[9].v);
+}
+
+TEST(TDynamicVector, uninitialized_constructor_default_constructs_non_trivial_types)
+{
+  TCounted::Reset();
+  TDynamicVector<TCounted> a(7, TUninitialized());
+  EXPECT_EQ(7, TCounted::defaults);
+  EXPECT_EQ(0, a[6].v);
+  ASSERT_NO_THROW(TDynamicVector<double> v(7, TUninitialized()));
+  ASSERT_ANY_THROW(TDynamicVector<double> v(0, TUninitialized()));
+}